@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavAnytimeSearch.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavNeighborKernel.h"
+#include "Algo/Reverse.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+FFlightNavAnytimeSearch::FFlightNavAnytimeSearch(const TMap<FVector, FAStarNode>& InGridNodes, float InNodeSize, const FFlightNavLandmarks* InLandmarks)
+	: GridNodes(InGridNodes)
+	, NodeSize(InNodeSize)
+	, Landmarks(InLandmarks)
+{
+}
+
+void FFlightNavAnytimeSearch::Begin(const FVector& Start, const FVector& Goal, float InitialEpsilon, float EpsilonStep)
+{
+	Records.Reset();
+	OpenHeap.Reset();
+	BestPath.Reset();
+	Stats = FFlightNavQueryStats();
+
+	StartCell = UFlightNavigationBFL::GetGridCenter(Start, NodeSize);
+	GoalCell = UFlightNavigationBFL::GetGridCenter(Goal, NodeSize);
+	GoalIndex = FlightNavNeighborKernel::ToCell(GoalCell, NodeSize);
+	if (!Landmarks || !Landmarks->PrepareGoal(GoalCell, GoalLandmarkDistances))
+	{
+		GoalLandmarkDistances.Reset();
+	}
+	Epsilon = FMath::Max(InitialEpsilon, 1.0f);
+	EpsilonDecrease = FMath::Max(EpsilonStep, KINDA_SMALL_NUMBER);
+	Iteration = 1;
+	SuboptimalityBound = TNumericLimits<float>::Max();
+	bFinished = false;
+
+	FindOrAddRecord(GoalCell);
+	FNodeRecord& StartRecord = FindOrAddRecord(StartCell);
+	StartRecord.G = 0.0f;
+	PushOpen(StartCell, StartRecord);
+}
+
+EFlightNavAnytimeStatus FFlightNavAnytimeSearch::Step(int32 ExpansionBudget)
+{
+	if (bFinished)
+	{
+		return BestPath.Num() > 0 ? EFlightNavAnytimeStatus::Optimal : EFlightNavAnytimeStatus::Failed;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_AnytimeSearchStep);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_FindPath);
+
+	const double StepStartSeconds = FPlatformTime::Seconds();
+	const EFlightNavAnytimeStatus Status = StepInternal(FMath::Max(ExpansionBudget, 1));
+	Stats.WallTimeMs += static_cast<float>((FPlatformTime::Seconds() - StepStartSeconds) * 1000.0);
+
+	// 整个搜索结束后才记一次查询，耗时为各帧实际花费的总和
+	if (bFinished)
+	{
+		FFlightNavMetrics::Get().RecordQuery(Stats);
+		FFlightNavMetrics::Get().RecordLatency(EFlightNavMetric::FindPath, Stats.WallTimeMs);
+	}
+	return Status;
+}
+
+EFlightNavAnytimeStatus FFlightNavAnytimeSearch::StepInternal(int32 ExpansionBudget)
+{
+	for (int32 Expanded = 0; Expanded < ExpansionBudget; ++Expanded)
+	{
+		// 终点的 g 不大于 OPEN 中最小的 key 时，本轮 Epsilon 的解已找到
+		const float GoalG = Records.FindChecked(GoalCell).G;
+		const float MinOpenKey = GetMinOpenKey();
+		if (GoalG <= MinOpenKey)
+		{
+			if (GoalG == TNumericLimits<float>::Max())
+			{
+				// OPEN 已空且终点不可达
+				bFinished = true;
+				return EFlightNavAnytimeStatus::Failed;
+			}
+			return PublishAndAdvance();
+		}
+
+		FOpenEntry Entry;
+		OpenHeap.HeapPop(Entry, EAllowShrinking::No);
+		++Stats.HeapOperations;
+		++Stats.NodesExpanded;
+
+		FNodeRecord& CurrentRecord = Records.FindChecked(Entry.Cell);
+		CurrentRecord.bInOpen = false;
+		CurrentRecord.ClosedIteration = Iteration;
+		// 展开邻居时 Records 可能扩容，先把需要的值拷出来
+		const float CurrentG = CurrentRecord.G;
+
+		const FIntVector CurrentIndex = FlightNavNeighborKernel::ToCell(Entry.Cell, NodeSize);
+		FFlightNavNeighborBatch Batch;
+		FlightNavNeighborKernel::Evaluate(CurrentIndex, GoalIndex, CurrentG, NodeSize, Batch);
+
+		for (int32 NeighborIndex = 0; NeighborIndex < FFlightNavNeighborBatch::NumNeighbors; ++NeighborIndex)
+		{
+			const FVector NeighborCell = FlightNavNeighborKernel::ToCenter(
+				CurrentIndex + FlightNavNeighborKernel::GetOffset(NeighborIndex), NodeSize);
+			if (!IsPassable(NeighborCell))
+			{
+				continue;
+			}
+
+			const float TentativeG = Batch.G[NeighborIndex];
+			FNodeRecord& NeighborRecord = FindOrAddRecord(NeighborCell);
+			if (TentativeG >= NeighborRecord.G)
+			{
+				continue;
+			}
+
+			NeighborRecord.G = TentativeG;
+			NeighborRecord.Parent = Entry.Cell;
+			NeighborRecord.bHasParent = true;
+
+			if (NeighborRecord.ClosedIteration != Iteration)
+			{
+				PushOpen(NeighborCell, NeighborRecord);
+			}
+			else
+			{
+				// 本轮已关闭的节点放入 INCONS，下一轮再处理
+				NeighborRecord.bInIncons = true;
+			}
+		}
+	}
+
+	return EFlightNavAnytimeStatus::Searching;
+}
+
+EFlightNavAnytimeStatus FFlightNavAnytimeSearch::PublishAndAdvance()
+{
+	RetraceBestPath();
+
+	// 次优上界：g(goal) / min(g + h)，取 OPEN 与 INCONS 中的所有节点
+	const float GoalG = Records.FindChecked(GoalCell).G;
+	float MinUnexpanded = GoalG;
+	for (const TPair<FVector, FNodeRecord>& Pair : Records)
+	{
+		if (Pair.Value.bInOpen || Pair.Value.bInIncons)
+		{
+			MinUnexpanded = FMath::Min(MinUnexpanded, Pair.Value.G + Pair.Value.H);
+		}
+	}
+	SuboptimalityBound = MinUnexpanded > 0.0f ? FMath::Min(Epsilon, GoalG / MinUnexpanded) : 1.0f;
+
+	if (Epsilon <= 1.0f || SuboptimalityBound <= 1.0f + KINDA_SMALL_NUMBER)
+	{
+		SuboptimalityBound = 1.0f;
+		bFinished = true;
+		return EFlightNavAnytimeStatus::Optimal;
+	}
+
+	// 减小 Epsilon，INCONS 并入 OPEN，按新的 key 重建堆，并清空 CLOSED
+	Epsilon = FMath::Max(1.0f, Epsilon - EpsilonDecrease);
+	++Iteration;
+
+	OpenHeap.Reset();
+	for (TPair<FVector, FNodeRecord>& Pair : Records)
+	{
+		FNodeRecord& Record = Pair.Value;
+		if (Record.bInIncons)
+		{
+			Record.bInIncons = false;
+			Record.bInOpen = true;
+		}
+		if (Record.bInOpen)
+		{
+			OpenHeap.Add({ Pair.Key, GetKey(Record) });
+		}
+	}
+	OpenHeap.Heapify();
+	++Stats.HeapOperations;
+
+	return EFlightNavAnytimeStatus::Improved;
+}
+
+void FFlightNavAnytimeSearch::RetraceBestPath()
+{
+	BestPath.Reset();
+
+	FVector Cell = GoalCell;
+	const FNodeRecord* Record = Records.Find(Cell);
+	// 防御性上限，避免父节点链异常时死循环
+	int32 Guard = Records.Num();
+	while (Record && Guard-- > 0)
+	{
+		BestPath.Add(Cell);
+		if (Cell == StartCell || !Record->bHasParent)
+		{
+			break;
+		}
+		Cell = Record->Parent;
+		Record = Records.Find(Cell);
+	}
+
+	Algo::Reverse(BestPath);
+}
+
+FFlightNavAnytimeSearch::FNodeRecord& FFlightNavAnytimeSearch::FindOrAddRecord(const FVector& Cell)
+{
+	if (FNodeRecord* Existing = Records.Find(Cell))
+	{
+		return *Existing;
+	}
+
+	FNodeRecord& Record = Records.Add(Cell);
+	Record.H = UFlightNavigationBFL::Heuristic(Cell, GoalCell);
+	if (GoalLandmarkDistances.Num() > 0)
+	{
+		Record.H = FMath::Max(Record.H, Landmarks->GetLowerBound(Cell, GoalLandmarkDistances));
+	}
+	return Record;
+}
+
+bool FFlightNavAnytimeSearch::IsPassable(const FVector& Cell) const
+{
+	// 与 FindPath 一致：网格外的终点视为可达
+	const FAStarNode* Node = GridNodes.Find(Cell);
+	if (Cell == GoalCell)
+	{
+		return !Node || Node->bIsWalkable;
+	}
+	return Node && Node->bIsWalkable;
+}
+
+void FFlightNavAnytimeSearch::PushOpen(const FVector& Cell, FNodeRecord& Record)
+{
+	Record.bInOpen = true;
+	OpenHeap.HeapPush({ Cell, GetKey(Record) });
+	++Stats.HeapOperations;
+}
+
+float FFlightNavAnytimeSearch::GetMinOpenKey()
+{
+	// 丢弃过期条目：节点已出堆，或 g 变小后已以更小的 key 重新入堆
+	while (OpenHeap.Num() > 0)
+	{
+		const FOpenEntry& Top = OpenHeap.HeapTop();
+		const FNodeRecord& Record = Records.FindChecked(Top.Cell);
+		if (Record.bInOpen && Top.Key == GetKey(Record))
+		{
+			return Top.Key;
+		}
+		OpenHeap.HeapPopDiscard(EAllowShrinking::No);
+		++Stats.HeapOperations;
+	}
+	return TNumericLimits<float>::Max();
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavBakeCommandlet.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavRecorder.h"
+#include "OctreeFlightComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+UFlightNavBakeCommandlet::UFlightNavBakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UFlightNavBakeCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Usage: -run=FlightNavBake -Map=<Map package> [-OutDir=<Directory>]"));
+		return 1;
+	}
+
+	FString OutDir = FPaths::ProjectSavedDir() / TEXT("FlightNav");
+	FParse::Value(*Params, TEXT("OutDir="), OutDir);
+
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Bake: cannot load map %s"), *MapName);
+		return 1;
+	}
+
+	// 光栅化只读取碰撞几何，不需要物理场景
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.InitializeScenes(false)
+			.AllowAudioPlayback(false)
+			.RequiresHitProxies(false)
+			.CreatePhysicsScene(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false)
+			.SetTransactional(false)
+			.CreateFXSystems(false));
+	}
+
+	int32 NumBaked = 0;
+	int32 NumFailed = 0;
+	for (const ULevel* Level : World->GetLevels())
+	{
+		if (!Level)
+		{
+			continue;
+		}
+		for (const AActor* Actor : Level->Actors)
+		{
+			if (!IsValid(Actor))
+			{
+				continue;
+			}
+			Actor->ForEachComponent<UOctreeFlightComponent>(false, [&](const UOctreeFlightComponent* Component)
+			{
+				FVector MinBounds;
+				FVector MaxBounds;
+				if (!Component->ComputeNavMeshBounds(MinBounds, MaxBounds))
+				{
+					UE_LOG(LogFlightNav, Warning, TEXT("Bake: %s has no nav mesh bounds volume, skipped."), *Component->GetPathName());
+					return;
+				}
+
+				const double StartSeconds = FPlatformTime::Seconds();
+				const TMap<FVector, FAStarNode> Grid = UFlightNavigationBFL::GenerateVoxelGridFromGeometry(World, MinBounds, MaxBounds, Component->NodeSize);
+				const double ElapsedMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+				if (Grid.Num() == 0)
+				{
+					UE_LOG(LogFlightNav, Error, TEXT("Bake: %s produced an empty grid."), *Component->GetPathName());
+					++NumFailed;
+					return;
+				}
+
+				FlightNavRecording::FGridSnapshot Snapshot;
+				if (!FlightNavRecording::FGridSnapshot::FromGrid(Grid, Component->NodeSize, Snapshot))
+				{
+					++NumFailed;
+					return;
+				}
+				TArray<uint8> Bytes;
+				Snapshot.SaveToBytes(Bytes);
+				const FString OutFile = OutDir / FString::Printf(TEXT("%s_%s.fnsnap"), *Actor->GetName(), *Component->GetName());
+				if (!FFileHelper::SaveArrayToFile(Bytes, *OutFile))
+				{
+					UE_LOG(LogFlightNav, Error, TEXT("Bake: cannot write %s"), *OutFile);
+					++NumFailed;
+					return;
+				}
+
+				UE_LOG(LogFlightNav, Display, TEXT("Bake: %s -> %s, %d voxels in %.1f ms"),
+					*Component->GetPathName(), *OutFile, Grid.Num(), ElapsedMs);
+				++NumBaked;
+			});
+		}
+	}
+
+	World->CleanupWorld();
+	World->RemoveFromRoot();
+
+	UE_LOG(LogFlightNav, Display, TEXT("Bake: %d grids written, %d failed."), NumBaked, NumFailed);
+	return NumFailed > 0 ? 1 : 0;
+}
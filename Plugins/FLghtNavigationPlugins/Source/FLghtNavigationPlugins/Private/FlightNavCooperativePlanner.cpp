@@ -0,0 +1,431 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavCooperativePlanner.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavNeighborKernel.h"
+#include "Algo/Reverse.h"
+#include "Misc/ScopeExit.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace FlightNavCooperative
+{
+	static constexpr float Unreachable = TNumericLimits<float>::Max();
+
+	// 预约时与其他智能体冲突后最多重新搜索的次数；每次冲突的 (格子, 时间片) 都会在下一次搜索中避开
+	static constexpr int32 MaxReserveAttempts = 8;
+
+	// 与 FindPath 一致：网格外的终点视为可达
+	static bool IsPassable(const TMap<FVector, FAStarNode>& GridNodes, const FIntVector& Cell, const FIntVector& GoalCell, float NodeSize)
+	{
+		const FAStarNode* Node = GridNodes.Find(FlightNavNeighborKernel::ToCenter(Cell, NodeSize));
+		if (Cell == GoalCell)
+		{
+			return !Node || Node->bIsWalkable;
+		}
+		return Node && Node->bIsWalkable;
+	}
+
+	// (格子, 时间片) 已被其他智能体预约，或在之前的提交中发生过冲突
+	static bool IsHeldByOther(const FFlightNavReservationTable& ReservationTable, const TSet<FFlightNavSpaceTimeKey>& Conflicts,
+		const FIntVector& Cell, int32 TimeSlot, uint32 AgentId)
+	{
+		const uint32 Owner = ReservationTable.GetOwner(Cell, TimeSlot);
+		return (Owner != FFlightNavReservationTable::NoAgent && Owner != AgentId)
+			|| Conflicts.Contains(FFlightNavSpaceTimeKey(Cell, TimeSlot));
+	}
+
+	/**
+	 * 反向可续算 A*（RRA*）
+	 *
+	 * 从终点向起点搜索，启发函数指向起点。需要某个格子到终点的距离时才继续扩展，
+	 * 直到该格子被关闭；由于启发函数一致，关闭时的 g 就是真实最短距离。
+	 */
+	class FReverseResumableSearch
+	{
+	public:
+		FReverseResumableSearch(const TMap<FVector, FAStarNode>& InGridNodes, float InNodeSize,
+			const FIntVector& InStartCell, const FIntVector& InGoalCell, FFlightNavQueryStats& InStats)
+			: GridNodes(InGridNodes)
+			, NodeSize(InNodeSize)
+			, StartCell(InStartCell)
+			, GoalCell(InGoalCell)
+			, Stats(InStats)
+		{
+			Records.Add(GoalCell).G = 0.0f;
+			Open.HeapPush({ GoalCell, 0.0f, 0.0f });
+			++Stats.HeapOperations;
+		}
+
+		// Cell 到终点的最短距离（忽略其他智能体），不可达时返回 Unreachable
+		float GetDistance(const FIntVector& Cell)
+		{
+			if (const FRecord* Existing = Records.Find(Cell))
+			{
+				if (Existing->bClosed)
+				{
+					return Existing->G;
+				}
+			}
+
+			while (Open.Num() > 0)
+			{
+				FEntry Entry;
+				Open.HeapPop(Entry, EAllowShrinking::No);
+				++Stats.HeapOperations;
+
+				FRecord& Record = Records.FindChecked(Entry.Cell);
+				if (Record.bClosed || Entry.G != Record.G)
+				{
+					continue;
+				}
+				Record.bClosed = true;
+				++Stats.NodesExpanded;
+
+				const float CurrentG = Record.G;
+				Expand(Entry.Cell, CurrentG);
+				if (Entry.Cell == Cell)
+				{
+					return CurrentG;
+				}
+			}
+			return Unreachable;
+		}
+
+		// 沿反向搜索树从 Cell 走向终点的下一格（Cell 必须已被 GetDistance 关闭）
+		bool GetNext(const FIntVector& Cell, FIntVector& OutNext) const
+		{
+			const FRecord* Record = Records.Find(Cell);
+			if (!Record || !Record->bHasNext)
+			{
+				return false;
+			}
+			OutNext = Record->Next;
+			return true;
+		}
+
+	private:
+		struct FRecord
+		{
+			float G = Unreachable;
+			FIntVector Next = FIntVector::ZeroValue;
+			bool bHasNext = false;
+			bool bClosed = false;
+		};
+
+		struct FEntry
+		{
+			FIntVector Cell;
+			float G;
+			float F;
+
+			bool operator<(const FEntry& Other) const { return F < Other.F; }
+		};
+
+		void Expand(const FIntVector& Cell, float CurrentG)
+		{
+			// 反向搜索的启发目标是起点
+			FFlightNavNeighborBatch Batch;
+			FlightNavNeighborKernel::Evaluate(Cell, StartCell, CurrentG, NodeSize, Batch);
+
+			for (int32 NeighborIndex = 0; NeighborIndex < FFlightNavNeighborBatch::NumNeighbors; ++NeighborIndex)
+			{
+				const FIntVector Neighbor = Cell + FlightNavNeighborKernel::GetOffset(NeighborIndex);
+				// 起点是智能体当前所在位置，总是可以站立
+				if (Neighbor != StartCell && !IsPassable(GridNodes, Neighbor, GoalCell, NodeSize))
+				{
+					continue;
+				}
+
+				FRecord& NeighborRecord = Records.FindOrAdd(Neighbor);
+				if (NeighborRecord.bClosed || Batch.G[NeighborIndex] >= NeighborRecord.G)
+				{
+					continue;
+				}
+				NeighborRecord.G = Batch.G[NeighborIndex];
+				NeighborRecord.Next = Cell;
+				NeighborRecord.bHasNext = true;
+
+				Open.HeapPush({ Neighbor, Batch.G[NeighborIndex], Batch.G[NeighborIndex] + Batch.H[NeighborIndex] });
+				++Stats.HeapOperations;
+			}
+		}
+
+		const TMap<FVector, FAStarNode>& GridNodes;
+		float NodeSize;
+		FIntVector StartCell;
+		FIntVector GoalCell;
+		FFlightNavQueryStats& Stats;
+
+		TMap<FIntVector, FRecord> Records;
+		TArray<FEntry> Open;
+	};
+
+	/**
+	 * 窗口内的时空搜索
+	 *
+	 * 只有终点在窗口剩余的时间片内都没有被别人占用时，到达终点才算结束，
+	 * 否则继续搜索（先在别处等待、之后再进入终点）。
+	 *
+	 * @param Conflicts 之前提交失败的 (格子, 时间片)，与预约表一样视为被占用
+	 * @param OutWindowCells 从起点开始每个时间片所在的格子
+	 * @return 找到窗口终点或到达终点时返回 true
+	 */
+	static bool SearchWindow(
+		const TMap<FVector, FAStarNode>& GridNodes,
+		float NodeSize,
+		const FFlightNavReservationTable& ReservationTable,
+		const TSet<FFlightNavSpaceTimeKey>& Conflicts,
+		const FFlightNavCooperativeRequest& Request,
+		const FIntVector& StartCell,
+		const FIntVector& GoalCell,
+		FReverseResumableSearch& Reverse,
+		TArray<FIntVector>& OutWindowCells,
+		FFlightNavQueryStats& Stats)
+	{
+		struct FStateRecord
+		{
+			float G = Unreachable;
+			FFlightNavSpaceTimeKey Parent;
+			bool bHasParent = false;
+			bool bClosed = false;
+		};
+
+		struct FStateEntry
+		{
+			FFlightNavSpaceTimeKey State;
+			float G;
+			float F;
+
+			bool operator<(const FStateEntry& Other) const { return F < Other.F; }
+		};
+
+		const float StartH = Reverse.GetDistance(StartCell);
+		if (StartH == Unreachable)
+		{
+			return false;
+		}
+
+		// 状态中的 TimeSlot 是相对 StartTimeSlot 的步数
+		TMap<FFlightNavSpaceTimeKey, FStateRecord> States;
+		TArray<FStateEntry> Open;
+
+		const FFlightNavSpaceTimeKey StartState(StartCell, 0);
+		States.Add(StartState).G = 0.0f;
+		Open.HeapPush({ StartState, 0.0f, StartH });
+		++Stats.HeapOperations;
+
+		// 从 Step 开始到窗口结束终点都空闲，才能在终点停留
+		auto CanIdleAtGoal = [&](int32 Step)
+		{
+			for (int32 IdleStep = Step; IdleStep <= Request.Window; ++IdleStep)
+			{
+				if (IsHeldByOther(ReservationTable, Conflicts, GoalCell, Request.StartTimeSlot + IdleStep, Request.AgentId))
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		bool bFound = false;
+		FFlightNavSpaceTimeKey FinalState;
+
+		while (Open.Num() > 0)
+		{
+			FStateEntry Entry;
+			Open.HeapPop(Entry, EAllowShrinking::No);
+			++Stats.HeapOperations;
+
+			FStateRecord& Record = States.FindChecked(Entry.State);
+			if (Record.bClosed || Entry.G != Record.G)
+			{
+				continue;
+			}
+			Record.bClosed = true;
+			++Stats.NodesExpanded;
+
+			const float CurrentG = Record.G;
+			const FIntVector Cell = Entry.State.Cell;
+			const int32 Step = Entry.State.TimeSlot;
+
+			// 到达终点，或走出窗口（窗口外的代价已由 RRA* 精确给出）
+			if ((Cell == GoalCell && CanIdleAtGoal(Step)) || Step >= Request.Window)
+			{
+				FinalState = Entry.State;
+				bFound = true;
+				break;
+			}
+
+			const int32 NextTimeSlot = Request.StartTimeSlot + Step + 1;
+
+			FFlightNavNeighborBatch Batch;
+			FlightNavNeighborKernel::Evaluate(Cell, GoalCell, CurrentG, NodeSize, Batch);
+
+			// 前 26 个动作是移动，最后一个是原地等待一个时间片
+			for (int32 ActionIndex = 0; ActionIndex <= FFlightNavNeighborBatch::NumNeighbors; ++ActionIndex)
+			{
+				const bool bWait = ActionIndex == FFlightNavNeighborBatch::NumNeighbors;
+				const FIntVector Next = bWait ? Cell : Cell + FlightNavNeighborKernel::GetOffset(ActionIndex);
+				const float NextG = bWait ? CurrentG + NodeSize : Batch.G[ActionIndex];
+
+				if (!bWait && !IsPassable(GridNodes, Next, GoalCell, NodeSize))
+				{
+					continue;
+				}
+
+				// 下一时间片该格子已被别人预约
+				if (IsHeldByOther(ReservationTable, Conflicts, Next, NextTimeSlot, Request.AgentId))
+				{
+					continue;
+				}
+
+				// 与别人对穿：对方此刻在 Next，下一时间片到 Cell
+				if (!bWait)
+				{
+					const uint32 SwapOwner = ReservationTable.GetOwner(Next, NextTimeSlot - 1);
+					if (SwapOwner != FFlightNavReservationTable::NoAgent && SwapOwner != Request.AgentId
+						&& ReservationTable.GetOwner(Cell, NextTimeSlot) == SwapOwner)
+					{
+						continue;
+					}
+				}
+
+				const float NextH = Reverse.GetDistance(Next);
+				if (NextH == Unreachable)
+				{
+					continue;
+				}
+
+				const FFlightNavSpaceTimeKey NextState(Next, Step + 1);
+				FStateRecord& NextRecord = States.FindOrAdd(NextState);
+				if (NextRecord.bClosed || NextG >= NextRecord.G)
+				{
+					continue;
+				}
+				NextRecord.G = NextG;
+				NextRecord.Parent = Entry.State;
+				NextRecord.bHasParent = true;
+
+				Open.HeapPush({ NextState, NextG, NextG + NextH });
+				++Stats.HeapOperations;
+			}
+		}
+
+		if (!bFound)
+		{
+			return false;
+		}
+
+		OutWindowCells.Reset();
+		FFlightNavSpaceTimeKey State = FinalState;
+		while (true)
+		{
+			OutWindowCells.Add(State.Cell);
+			const FStateRecord& Record = States.FindChecked(State);
+			if (!Record.bHasParent)
+			{
+				break;
+			}
+			State = Record.Parent;
+		}
+		Algo::Reverse(OutWindowCells);
+		return true;
+	}
+}
+
+TArray<FVector> FFlightNavCooperativePlanner::Plan(
+	const TMap<FVector, FAStarNode>& GridNodes,
+	float NodeSize,
+	FFlightNavReservationTable& ReservationTable,
+	const FFlightNavCooperativeRequest& Request,
+	TArray<FFlightNavSpaceTimeKey>& OutReservations,
+	FFlightNavQueryStats& OutStats)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_CooperativePlan);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_FindPath);
+
+	OutStats = FFlightNavQueryStats();
+	OutReservations.Reset();
+	FFlightNavScopedLatency Latency(EFlightNavMetric::FindPath);
+	ON_SCOPE_EXIT
+	{
+		OutStats.WallTimeMs = static_cast<float>(Latency.GetElapsedMs());
+		FFlightNavMetrics::Get().RecordQuery(OutStats);
+	};
+
+	if (Request.AgentId == FFlightNavReservationTable::NoAgent)
+	{
+		return TArray<FVector>();
+	}
+
+	const int32 Window = FMath::Max(Request.Window, 1);
+	FFlightNavCooperativeRequest ClampedRequest = Request;
+	ClampedRequest.Window = Window;
+
+	const FIntVector StartCell = FlightNavNeighborKernel::ToCell(UFlightNavigationBFL::GetGridCenter(Request.Start, NodeSize), NodeSize);
+	const FIntVector GoalCell = FlightNavNeighborKernel::ToCell(UFlightNavigationBFL::GetGridCenter(Request.Goal, NodeSize), NodeSize);
+
+	// RRA* 的结果与其他智能体无关，多次尝试之间可以复用
+	FlightNavCooperative::FReverseResumableSearch Reverse(GridNodes, NodeSize, StartCell, GoalCell, OutStats);
+
+	// 提交失败的 (格子, 时间片)，下一次搜索会绕开，保证每次重试的结果不同
+	TSet<FFlightNavSpaceTimeKey> Conflicts;
+
+	for (int32 Attempt = 0; Attempt < FlightNavCooperative::MaxReserveAttempts; ++Attempt)
+	{
+		TArray<FIntVector> WindowCells;
+		if (!FlightNavCooperative::SearchWindow(GridNodes, NodeSize, ReservationTable, Conflicts, ClampedRequest,
+			StartCell, GoalCell, Reverse, WindowCells, OutStats))
+		{
+			return TArray<FVector>();
+		}
+
+		// 智能体此刻就在起点，无法避让：起点当前时间片已被别人占用时不预约，从下一个时间片开始预约
+		const int32 FirstReservedStep = FlightNavCooperative::IsHeldByOther(ReservationTable, Conflicts,
+			StartCell, Request.StartTimeSlot, Request.AgentId) ? 1 : 0;
+
+		// 提交窗口内的预约；提前到达终点时在终点停留到窗口结束
+		bool bConflict = false;
+		for (int32 Step = FirstReservedStep; Step <= Window; ++Step)
+		{
+			const FIntVector& Cell = WindowCells.IsValidIndex(Step) ? WindowCells[Step] : WindowCells.Last();
+			if (!ReservationTable.TryReserve(Cell, Request.StartTimeSlot + Step, Request.AgentId))
+			{
+				Conflicts.Add(FFlightNavSpaceTimeKey(Cell, Request.StartTimeSlot + Step));
+				bConflict = true;
+				break;
+			}
+			OutReservations.Emplace(Cell, Request.StartTimeSlot + Step);
+		}
+
+		if (bConflict)
+		{
+			// 搜索与提交之间别人抢先预约了，撤回后带着冲突记录重新搜索
+			ReservationTable.Release(OutReservations, Request.AgentId);
+			OutReservations.Reset();
+			continue;
+		}
+
+		TArray<FVector> Path;
+		for (const FIntVector& Cell : WindowCells)
+		{
+			Path.Add(FlightNavNeighborKernel::ToCenter(Cell, NodeSize));
+		}
+
+		// 窗口之后沿 RRA* 的搜索树直接走到终点
+		FIntVector Cell = WindowCells.Last();
+		FIntVector Next;
+		int32 Guard = GridNodes.Num() + 1;
+		while (Cell != GoalCell && Reverse.GetNext(Cell, Next) && Guard-- > 0)
+		{
+			Cell = Next;
+			Path.Add(FlightNavNeighborKernel::ToCenter(Cell, NodeSize));
+		}
+		return Path;
+	}
+
+	UE_LOG(LogFlightNav, Verbose, TEXT("Cooperative plan for agent %u gave up after %d reservation conflicts."),
+		Request.AgentId, FlightNavCooperative::MaxReserveAttempts);
+	return TArray<FVector>();
+}
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavDataHandle.h"
+#include "OctreeFlightComponent.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavNeighborKernel.h"
+
+FFlightNavDataHandle::FFlightNavDataHandle(const UOctreeFlightComponent* InOwner)
+	: Owner(const_cast<UOctreeFlightComponent*>(InOwner))
+{
+}
+
+bool FFlightNavDataHandle::IsValid() const
+{
+	const UOctreeFlightComponent* Component = Owner.Get();
+	return Component && Component->VoxelGrids.Num() > 0;
+}
+
+const TMap<FVector, FAStarNode>* FFlightNavDataHandle::GetGrid() const
+{
+	return IsValid() ? &Owner->VoxelGrids : nullptr;
+}
+
+const FFlightNavLandmarks* FFlightNavDataHandle::GetLandmarks() const
+{
+	return IsValid() ? Owner->GetLandmarks() : nullptr;
+}
+
+float FFlightNavDataHandle::GetNodeSize() const
+{
+	return IsValid() ? Owner->NodeSize : 0.0f;
+}
+
+FBox FFlightNavDataHandle::GetBounds() const
+{
+	return IsValid() ? FBox(Owner->NavMeshMinBounds, Owner->NavMeshMaxBounds) : FBox(ForceInit);
+}
+
+const FAStarNode* FFlightNavDataHandle::FindCell(const FVector& WorldLocation) const
+{
+	const TMap<FVector, FAStarNode>* Grid = GetGrid();
+	if (!Grid)
+	{
+		return nullptr;
+	}
+	return Grid->Find(UFlightNavigationBFL::GetGridCenter(WorldLocation, Owner->NodeSize));
+}
+
+void FFlightNavDataHandle::ForEachCellInBox(const FBox& Region, TFunctionRef<bool(const FAStarNode&)> Visitor) const
+{
+	const TMap<FVector, FAStarNode>* Grid = GetGrid();
+	if (!Grid || !Region.IsValid)
+	{
+		return;
+	}
+
+	// 先裁剪到网格范围，再按整数格子坐标逐个查找
+	const FBox Clipped = Region.Overlap(GetBounds());
+	if (!Clipped.IsValid)
+	{
+		return;
+	}
+
+	const float NodeSize = Owner->NodeSize;
+	FIntVector MinCell;
+	FIntVector MaxCell;
+	FlightNavNeighborKernel::ToCellRange(Clipped, NodeSize, MinCell, MaxCell);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const FAStarNode* Node = Grid->Find(FlightNavNeighborKernel::ToCenter(FIntVector(X, Y, Z), NodeSize));
+				if (Node && !Visitor(*Node))
+				{
+					return;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,484 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavDebugDrawComponent.h"
+#include "OctreeFlightComponent.h"
+#include "PrimitiveSceneProxy.h"
+#include "SceneManagement.h"
+#include "SceneView.h"
+#include "UObject/UObjectIterator.h"
+#include "HAL/IConsoleManager.h"
+#include "DynamicMeshBuilder.h"
+#include "LocalVertexFactory.h"
+#include "StaticMeshResources.h"
+#include "Materials/Material.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+namespace FlightNavDebugDraw
+{
+	// 显示模式
+	enum EViewMode : int32
+	{
+		AllCells = 0,
+		BlockedOnly = 1,
+		PathOnly = 2,
+	};
+
+	// 格子分组，每组一种颜色；路径格子单独存放
+	enum ECellGroup : int32
+	{
+		Blocked = 0,
+		Walkable = 1,
+		NumCellGroups = 2,
+	};
+
+	// LOD 最多稀疏到每 2^MaxLODLevel 个格子画一个
+	static constexpr int32 MaxLODLevel = 4;
+
+	// 线段按 2^ChunkShift 个格子边长的区块组织，距离裁剪与 LOD 以区块为单位
+	static constexpr int32 ChunkShift = 4;
+
+	static void OnDebugDrawChanged(IConsoleVariable* Variable)
+	{
+		// 开关或切片变化时重建所有调试绘制的 SceneProxy（关闭时即销毁）
+		for (TObjectIterator<UFlightNavDebugDrawComponent> It; It; ++It)
+		{
+			if (It->IsRegistered())
+			{
+				It->UpdateBounds();
+				It->MarkRenderStateDirty();
+			}
+		}
+
+		// 打开时为还没有调试绘制组件的导航组件创建
+		if (UFlightNavDebugDrawComponent::IsDebugDrawEnabled())
+		{
+			for (TObjectIterator<UOctreeFlightComponent> It; It; ++It)
+			{
+				if (It->IsRegistered() && It->GetWorld() && It->GetWorld()->IsGameWorld())
+				{
+					It->RefreshDebugDraw();
+				}
+			}
+		}
+	}
+}
+
+static TAutoConsoleVariable<int32> CVarFlightNavDebugDraw(
+	TEXT("FlightNav.Debug.Draw"),
+	0,
+	TEXT("是否绘制飞行导航体素网格。0: 关闭（无任何开销），1: 打开"),
+	FConsoleVariableDelegate::CreateStatic(&FlightNavDebugDraw::OnDebugDrawChanged),
+	ECVF_Cheat | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarFlightNavDebugView(
+	TEXT("FlightNav.Debug.View"),
+	0,
+	TEXT("显示内容。0: 全部体素，1: 只显示阻挡体素，2: 只显示当前路径"),
+	ECVF_Cheat | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<int32> CVarFlightNavDebugSliceAxis(
+	TEXT("FlightNav.Debug.SliceAxis"),
+	0,
+	TEXT("切片轴。0: 不切片，1: X，2: Y，3: Z"),
+	FConsoleVariableDelegate::CreateStatic(&FlightNavDebugDraw::OnDebugDrawChanged),
+	ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarFlightNavDebugSlicePosition(
+	TEXT("FlightNav.Debug.SlicePosition"),
+	0.0f,
+	TEXT("切片平面在切片轴上的世界坐标"),
+	FConsoleVariableDelegate::CreateStatic(&FlightNavDebugDraw::OnDebugDrawChanged),
+	ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarFlightNavDebugSliceThickness(
+	TEXT("FlightNav.Debug.SliceThickness"),
+	0.0f,
+	TEXT("切片厚度，<= 0 时为一个体素"),
+	FConsoleVariableDelegate::CreateStatic(&FlightNavDebugDraw::OnDebugDrawChanged),
+	ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarFlightNavDebugLODDistance(
+	TEXT("FlightNav.Debug.LODDistance"),
+	5000.0f,
+	TEXT("超过该距离后，每翻一倍距离体素绘制密度在每个轴上减半。<= 0 关闭 LOD"),
+	ECVF_Cheat | ECVF_RenderThreadSafe);
+
+static TAutoConsoleVariable<float> CVarFlightNavDebugMaxDistance(
+	TEXT("FlightNav.Debug.MaxDistance"),
+	20000.0f,
+	TEXT("超过该距离的体素不绘制（路径除外）。<= 0 不限制"),
+	ECVF_Cheat | ECVF_RenderThreadSafe);
+
+/*-----------SceneProxy-----------------*/
+class FFlightNavDebugSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+	FFlightNavDebugSceneProxy(const UFlightNavDebugDrawComponent* InComponent, const UOctreeFlightComponent& Source)
+		: FPrimitiveSceneProxy(InComponent)
+		, CellSize(Source.NodeSize)
+		, VertexFactory(GetScene().GetFeatureLevel(), "FFlightNavDebugSceneProxy")
+		, MaterialProxy(GEngine->VertexColorMaterial->GetRenderProxy())
+		, MaterialRelevance(GEngine->VertexColorMaterial->GetRelevance_Concurrent(GetScene().GetFeatureLevel()))
+	{
+		BuildLines(Source, InComponent->GetComponentTransform());
+
+		for (const FVector& Point : Source.GetCurrentPath())
+		{
+			PathPoints.Add(Point);
+		}
+
+		if (NumVertices > 0)
+		{
+			BeginInitResource(&VertexBuffers.PositionVertexBuffer);
+			BeginInitResource(&VertexBuffers.StaticMeshVertexBuffer);
+			BeginInitResource(&VertexBuffers.ColorVertexBuffer);
+			BeginInitResource(&IndexBuffer);
+			BeginInitResource(&VertexFactory);
+		}
+	}
+
+	virtual ~FFlightNavDebugSceneProxy() override
+	{
+		VertexBuffers.PositionVertexBuffer.ReleaseResource();
+		VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+		VertexBuffers.ColorVertexBuffer.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		VertexFactory.ReleaseResource();
+	}
+
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+	{
+		FPrimitiveViewRelevance Result;
+		Result.bDrawRelevance = IsShown(View) && CVarFlightNavDebugDraw.GetValueOnRenderThread() != 0;
+		Result.bDynamicRelevance = true;
+		Result.bShadowRelevance = false;
+		Result.bEditorPrimitiveRelevance = UseEditorCompositing(View);
+		MaterialRelevance.SetPrimitiveViewRelevance(Result);
+		return Result;
+	}
+
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily,
+		uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+	{
+		const int32 ViewMode = CVarFlightNavDebugView.GetValueOnRenderThread();
+		const double LODDistance = CVarFlightNavDebugLODDistance.GetValueOnRenderThread();
+		const double MaxDistance = CVarFlightNavDebugMaxDistance.GetValueOnRenderThread();
+
+		for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+		{
+			if (!(VisibilityMap & (1 << ViewIndex)))
+			{
+				continue;
+			}
+
+			const FVector ViewOrigin = Views[ViewIndex]->ViewMatrices.GetViewOrigin();
+
+			// 每帧只按区块挑选索引范围，不再逐格子生成线段
+			if (NumVertices > 0 && ViewMode != FlightNavDebugDraw::PathOnly)
+			{
+				for (const FChunk& Chunk : Chunks)
+				{
+					const double Distance = FMath::Sqrt(Chunk.Bounds.ComputeSquaredDistanceToPoint(ViewOrigin));
+					if (MaxDistance > 0.0 && Distance > MaxDistance)
+					{
+						continue;
+					}
+
+					// 距离 LOD：超过 LODDistance 后按 2 的幂稀疏采样格子
+					int32 Level = 0;
+					if (LODDistance > 0.0 && Distance > LODDistance)
+					{
+						Level = FMath::Min(static_cast<int32>(FMath::FloorLog2(static_cast<uint32>(Distance / LODDistance))) + 1,
+							FlightNavDebugDraw::MaxLODLevel);
+					}
+
+					AddLines(Collector, ViewIndex, Chunk.Ranges[FlightNavDebugDraw::Blocked][Level]);
+					if (ViewMode == FlightNavDebugDraw::AllCells)
+					{
+						AddLines(Collector, ViewIndex, Chunk.Ranges[FlightNavDebugDraw::Walkable][Level]);
+					}
+				}
+			}
+
+			// 路径不受切片与 LOD 影响
+			if (NumVertices > 0)
+			{
+				AddLines(Collector, ViewIndex, PathRange);
+			}
+			FPrimitiveDrawInterface* PDI = Collector.GetPDI(ViewIndex);
+			for (int32 Index = 1; Index < PathPoints.Num(); ++Index)
+			{
+				PDI->DrawLine(PathPoints[Index - 1], PathPoints[Index], FLinearColor::Yellow, SDPG_Foreground, 2.0f);
+			}
+		}
+	}
+
+	virtual uint32 GetMemoryFootprint() const override
+	{
+		return sizeof(*this) + GetAllocatedSize();
+	}
+
+	uint32 GetAllocatedSize() const
+	{
+		return FPrimitiveSceneProxy::GetAllocatedSize()
+			+ Chunks.GetAllocatedSize()
+			+ PathPoints.GetAllocatedSize()
+			+ IndexBuffer.Indices.GetAllocatedSize()
+			+ VertexBuffers.PositionVertexBuffer.GetAllocatedSize()
+			+ VertexBuffers.StaticMeshVertexBuffer.GetResourceSize()
+			+ VertexBuffers.ColorVertexBuffer.GetAllocatedSize();
+	}
+
+private:
+	// 索引缓冲中的一段线段
+	struct FIndexRange
+	{
+		uint32 FirstIndex = 0;
+		uint32 NumIndices = 0;
+	};
+
+	// 一个区块内各分组、各 LOD 级别的线段
+	struct FChunk
+	{
+		FBox Bounds = FBox(ForceInit);
+		FIndexRange Ranges[FlightNavDebugDraw::NumCellGroups][FlightNavDebugDraw::MaxLODLevel + 1];
+	};
+
+	// 构建时每个分组的格子，按区块归类
+	struct FChunkCells
+	{
+		TArray<FIntVector> Cells[FlightNavDebugDraw::NumCellGroups];
+	};
+
+	FIntVector ToCell(const FVector& Center) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(Center.X / CellSize),
+			FMath::FloorToInt(Center.Y / CellSize),
+			FMath::FloorToInt(Center.Z / CellSize));
+	}
+
+	// 格子坐标都能被 2^Level 整除时，该格子在 Level 级 LOD 中仍会绘制
+	static int32 GetCellLODLevel(const FIntVector& Cell)
+	{
+		const uint32 Bits = static_cast<uint32>(Cell.X | Cell.Y | Cell.Z);
+		return FMath::Min(static_cast<int32>(FMath::CountTrailingZeros(Bits)), FlightNavDebugDraw::MaxLODLevel);
+	}
+
+	// 构造时（GameThread）把网格一次性转换为线段列表；切片设置变化时整个 SceneProxy 会重建
+	void BuildLines(const UOctreeFlightComponent& Source, const FTransform& ComponentTransform)
+	{
+		const int32 SliceAxis = CVarFlightNavDebugSliceAxis.GetValueOnGameThread();
+		const double SlicePosition = CVarFlightNavDebugSlicePosition.GetValueOnGameThread();
+		const double SliceHalfThickness = FMath::Max(CVarFlightNavDebugSliceThickness.GetValueOnGameThread(), CellSize) * 0.5;
+
+		TMap<FIntVector, FChunkCells> CellsByChunk;
+		for (const TPair<FVector, FAStarNode>& Voxel : Source.VoxelGrids)
+		{
+			if (SliceAxis >= 1 && SliceAxis <= 3 && FMath::Abs(Voxel.Key[SliceAxis - 1] - SlicePosition) > SliceHalfThickness)
+			{
+				continue;
+			}
+
+			const FIntVector Cell = ToCell(Voxel.Key);
+			const FIntVector ChunkKey(Cell.X >> FlightNavDebugDraw::ChunkShift, Cell.Y >> FlightNavDebugDraw::ChunkShift, Cell.Z >> FlightNavDebugDraw::ChunkShift);
+			const int32 Group = Voxel.Value.bIsWalkable ? FlightNavDebugDraw::Walkable : FlightNavDebugDraw::Blocked;
+			CellsByChunk.FindOrAdd(ChunkKey).Cells[Group].Add(Cell);
+		}
+
+		// 同一分组内相邻格子共用角点
+		TArray<FDynamicMeshVertex> Vertices;
+		TMap<FIntVector, uint32> CornerVertices[FlightNavDebugDraw::NumCellGroups + 1];
+		TArray<uint32>& Indices = IndexBuffer.Indices;
+
+		auto AddCellBox = [&](const FIntVector& Cell, int32 Group, const FColor& Color)
+		{
+			static constexpr uint8 Edges[12][2] = {
+				{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+				{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+				{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 } };
+
+			uint32 Corners[8];
+			for (int32 CornerIndex = 0; CornerIndex < 8; ++CornerIndex)
+			{
+				const FIntVector Corner = Cell + FIntVector(CornerIndex & 1, (CornerIndex >> 1) & 1, (CornerIndex >> 2) & 1);
+				if (const uint32* Existing = CornerVertices[Group].Find(Corner))
+				{
+					Corners[CornerIndex] = *Existing;
+					continue;
+				}
+				const FVector LocalPosition = ComponentTransform.InverseTransformPosition(FVector(Corner) * CellSize);
+				Corners[CornerIndex] = Vertices.Emplace(FVector3f(LocalPosition), FVector2f::ZeroVector, Color);
+				CornerVertices[Group].Add(Corner, Corners[CornerIndex]);
+			}
+			for (const uint8 (&Edge)[2] : Edges)
+			{
+				Indices.Add(Corners[Edge[0]]);
+				Indices.Add(Corners[Edge[1]]);
+			}
+		};
+
+		const FColor GroupColors[FlightNavDebugDraw::NumCellGroups] = { FColor::Red, FColor::Green };
+		Chunks.Reserve(CellsByChunk.Num());
+		for (const TPair<FIntVector, FChunkCells>& Pair : CellsByChunk)
+		{
+			FChunk& Chunk = Chunks.AddDefaulted_GetRef();
+			const FVector ChunkMin = FVector(Pair.Key * (1 << FlightNavDebugDraw::ChunkShift)) * CellSize;
+			Chunk.Bounds = FBox(ChunkMin, ChunkMin + FVector((1 << FlightNavDebugDraw::ChunkShift) * CellSize));
+
+			for (int32 Group = 0; Group < FlightNavDebugDraw::NumCellGroups; ++Group)
+			{
+				// 每个 LOD 级别一段连续索引，稀疏级别的格子在低级别中重复出现（总量约多 1/7）
+				for (int32 Level = 0; Level <= FlightNavDebugDraw::MaxLODLevel; ++Level)
+				{
+					FIndexRange& Range = Chunk.Ranges[Group][Level];
+					Range.FirstIndex = Indices.Num();
+					for (const FIntVector& Cell : Pair.Value.Cells[Group])
+					{
+						if (GetCellLODLevel(Cell) >= Level)
+						{
+							AddCellBox(Cell, Group, GroupColors[Group]);
+						}
+					}
+					Range.NumIndices = Indices.Num() - Range.FirstIndex;
+				}
+			}
+		}
+
+		PathRange.FirstIndex = Indices.Num();
+		TSet<FIntVector> PathCells;
+		for (const FVector& Point : Source.GetCurrentPath())
+		{
+			const FIntVector Cell = ToCell(Point);
+			bool bAlreadyAdded = false;
+			PathCells.Add(Cell, &bAlreadyAdded);
+			if (!bAlreadyAdded)
+			{
+				AddCellBox(Cell, FlightNavDebugDraw::NumCellGroups, FColor::Yellow);
+			}
+		}
+		PathRange.NumIndices = Indices.Num() - PathRange.FirstIndex;
+
+		NumVertices = Vertices.Num();
+		if (NumVertices > 0)
+		{
+			VertexBuffers.InitFromDynamicVertex(&VertexFactory, Vertices);
+		}
+	}
+
+	void AddLines(FMeshElementCollector& Collector, int32 ViewIndex, const FIndexRange& Range) const
+	{
+		if (Range.NumIndices == 0)
+		{
+			return;
+		}
+
+		FMeshBatch& Mesh = Collector.AllocateMesh();
+		Mesh.VertexFactory = &VertexFactory;
+		Mesh.MaterialRenderProxy = MaterialProxy;
+		Mesh.Type = PT_LineList;
+		Mesh.DepthPriorityGroup = SDPG_World;
+		Mesh.bCanApplyViewModeOverrides = false;
+		Mesh.bDisableBackfaceCulling = true;
+		Mesh.CastShadow = false;
+
+		FMeshBatchElement& Element = Mesh.Elements[0];
+		Element.IndexBuffer = &IndexBuffer;
+		Element.FirstIndex = Range.FirstIndex;
+		Element.NumPrimitives = Range.NumIndices / 2;
+		Element.MinVertexIndex = 0;
+		Element.MaxVertexIndex = NumVertices - 1;
+		Element.PrimitiveUniformBuffer = GetUniformBuffer();
+
+		Collector.AddMesh(ViewIndex, Mesh);
+	}
+
+	float CellSize;
+	TArray<FChunk> Chunks;
+	FIndexRange PathRange;
+	TArray<FVector> PathPoints;
+
+	int32 NumVertices = 0;
+	FStaticMeshVertexBuffers VertexBuffers;
+	FDynamicMeshIndexBuffer32 IndexBuffer;
+	FLocalVertexFactory VertexFactory;
+	FMaterialRenderProxy* MaterialProxy;
+	FMaterialRelevance MaterialRelevance;
+};
+
+/*-----------Component-----------------*/
+UFlightNavDebugDrawComponent::UFlightNavDebugDrawComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	SetCastShadow(false);
+	bIsEditorOnly = false;
+	// 网格以世界坐标绘制，不跟随 Owner 移动
+	SetUsingAbsoluteLocation(true);
+	SetUsingAbsoluteRotation(true);
+	SetUsingAbsoluteScale(true);
+}
+
+void UFlightNavDebugDrawComponent::SetSourceComponent(UOctreeFlightComponent* InSourceComponent)
+{
+	SourceComponent = InSourceComponent;
+}
+
+void UFlightNavDebugDrawComponent::RefreshDebugDraw()
+{
+	if (!IsDebugDrawEnabled() || !IsRegistered())
+	{
+		return;
+	}
+
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+bool UFlightNavDebugDrawComponent::IsDebugDrawEnabled()
+{
+	return CVarFlightNavDebugDraw.GetValueOnGameThread() != 0;
+}
+
+FPrimitiveSceneProxy* UFlightNavDebugDrawComponent::CreateSceneProxy()
+{
+	const UOctreeFlightComponent* Source = SourceComponent.Get();
+	if (!IsDebugDrawEnabled() || !Source || Source->VoxelGrids.Num() == 0)
+	{
+		return nullptr;
+	}
+	return new FFlightNavDebugSceneProxy(this, *Source);
+}
+
+void UFlightNavDebugDrawComponent::GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials) const
+{
+	if (GEngine && GEngine->VertexColorMaterial)
+	{
+		OutMaterials.Add(GEngine->VertexColorMaterial);
+	}
+}
+
+FBoxSphereBounds UFlightNavDebugDrawComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	const UOctreeFlightComponent* Source = SourceComponent.Get();
+	if (!Source || Source->VoxelGrids.Num() == 0)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+	}
+
+	FBox Bounds(Source->NavMeshMinBounds, Source->NavMeshMaxBounds);
+	for (const FVector& Point : Source->GetCurrentPath())
+	{
+		Bounds += Point;
+	}
+	return FBoxSphereBounds(Bounds.ExpandBy(Source->NodeSize));
+}
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavLandmarks.h"
+#include "FlightNavNeighborKernel.h"
+#include "FlightNavStats.h"
+#include "Async/ParallelFor.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace FlightNavLandmarks
+{
+	static constexpr float Unreachable = TNumericLimits<float>::Max();
+
+	struct FEntry
+	{
+		int32 CellIndex;
+		float G;
+
+		bool operator<(const FEntry& Other) const { return G < Other.G; }
+	};
+
+	// 单源 Dijkstra，图为可通行格子之间的 26 邻接
+	static void ComputeDistances(const TMap<FVector, int32>& CellIndices, const TArray<FVector>& Cells,
+		float NodeSize, int32 SourceIndex, TArray<float>& OutDistances)
+	{
+		OutDistances.Init(Unreachable, Cells.Num());
+		OutDistances[SourceIndex] = 0.0f;
+
+		TArray<FEntry> Open;
+		Open.HeapPush({ SourceIndex, 0.0f });
+
+		while (Open.Num() > 0)
+		{
+			FEntry Entry;
+			Open.HeapPop(Entry, EAllowShrinking::No);
+			if (Entry.G > OutDistances[Entry.CellIndex])
+			{
+				continue;
+			}
+
+			const FIntVector Cell = FlightNavNeighborKernel::ToCell(Cells[Entry.CellIndex], NodeSize);
+			FFlightNavNeighborBatch Batch;
+			FlightNavNeighborKernel::Evaluate(Cell, Cell, Entry.G, NodeSize, Batch);
+
+			for (int32 NeighborIndex = 0; NeighborIndex < FFlightNavNeighborBatch::NumNeighbors; ++NeighborIndex)
+			{
+				const int32* Neighbor = CellIndices.Find(FlightNavNeighborKernel::ToCenter(Cell + FlightNavNeighborKernel::GetOffset(NeighborIndex), NodeSize));
+				if (Neighbor && Batch.G[NeighborIndex] < OutDistances[*Neighbor])
+				{
+					OutDistances[*Neighbor] = Batch.G[NeighborIndex];
+					Open.HeapPush({ *Neighbor, Batch.G[NeighborIndex] });
+				}
+			}
+		}
+	}
+}
+
+void FFlightNavLandmarks::Build(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize, int32 NumLandmarks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_BuildLandmarks);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_BuildLandmarks);
+
+	Reset();
+	if (NumLandmarks <= 0 || NodeSize <= 0.0f)
+	{
+		return;
+	}
+
+	// 给可通行格子编号（按网格的插入顺序，保证同一份网格结果确定）
+	TArray<FVector> Cells;
+	FVector Centroid = FVector::ZeroVector;
+	for (const TPair<FVector, FAStarNode>& Voxel : GridNodes)
+	{
+		if (Voxel.Value.bIsWalkable)
+		{
+			CellIndices.Add(Voxel.Key, Cells.Num());
+			Cells.Add(Voxel.Key);
+			Centroid += Voxel.Key;
+		}
+	}
+	if (Cells.Num() == 0)
+	{
+		return;
+	}
+	Centroid /= Cells.Num();
+
+	// 欧几里得最远点采样
+	const int32 LandmarkCount = FMath::Min(NumLandmarks, Cells.Num());
+	TArray<int32> LandmarkIndices;
+	TArray<double> DistanceToNearestLandmark;
+	DistanceToNearestLandmark.Init(TNumericLimits<double>::Max(), Cells.Num());
+
+	int32 NextIndex = 0;
+	double FarthestFromCentroid = -1.0;
+	for (int32 Index = 0; Index < Cells.Num(); ++Index)
+	{
+		const double DistanceSquared = FVector::DistSquared(Cells[Index], Centroid);
+		if (DistanceSquared > FarthestFromCentroid)
+		{
+			FarthestFromCentroid = DistanceSquared;
+			NextIndex = Index;
+		}
+	}
+
+	while (LandmarkIndices.Num() < LandmarkCount)
+	{
+		LandmarkIndices.Add(NextIndex);
+
+		double Farthest = -1.0;
+		for (int32 Index = 0; Index < Cells.Num(); ++Index)
+		{
+			DistanceToNearestLandmark[Index] = FMath::Min(DistanceToNearestLandmark[Index], FVector::DistSquared(Cells[Index], Cells[NextIndex]));
+			if (DistanceToNearestLandmark[Index] > Farthest)
+			{
+				Farthest = DistanceToNearestLandmark[Index];
+				NextIndex = Index;
+			}
+		}
+
+		// 剩下的格子都已经是地标
+		if (Farthest <= 0.0)
+		{
+			break;
+		}
+	}
+
+	for (const int32 LandmarkIndex : LandmarkIndices)
+	{
+		LandmarkCells.Add(Cells[LandmarkIndex]);
+	}
+
+	// 每个地标一次 Dijkstra，并行计算
+	Distances.SetNum(LandmarkIndices.Num());
+	ParallelFor(LandmarkIndices.Num(), [this, &Cells, &LandmarkIndices, NodeSize](int32 Index)
+	{
+		FlightNavLandmarks::ComputeDistances(CellIndices, Cells, NodeSize, LandmarkIndices[Index], Distances[Index]);
+	});
+
+	UE_LOG(LogFlightNav, Log, TEXT("Built %d ALT landmarks over %d walkable cells (%.1f MB)."),
+		LandmarkCells.Num(), Cells.Num(), GetAllocatedSize() / (1024.0 * 1024.0));
+}
+
+void FFlightNavLandmarks::Reset()
+{
+	CellIndices.Reset();
+	LandmarkCells.Reset();
+	Distances.Reset();
+}
+
+bool FFlightNavLandmarks::PrepareGoal(const FVector& GoalCell, TArray<float>& OutGoalDistances) const
+{
+	OutGoalDistances.Reset();
+
+	const int32* GoalIndex = CellIndices.Find(GoalCell);
+	if (!GoalIndex)
+	{
+		return false;
+	}
+
+	OutGoalDistances.Reserve(Distances.Num());
+	for (const TArray<float>& LandmarkDistances : Distances)
+	{
+		OutGoalDistances.Add(LandmarkDistances[*GoalIndex]);
+	}
+	return true;
+}
+
+float FFlightNavLandmarks::GetLowerBound(const FVector& Cell, TConstArrayView<float> GoalDistances) const
+{
+	if (GoalDistances.Num() != Distances.Num())
+	{
+		return 0.0f;
+	}
+
+	const int32* CellIndex = CellIndices.Find(Cell);
+	if (!CellIndex)
+	{
+		return 0.0f;
+	}
+
+	float Bound = 0.0f;
+	for (int32 Landmark = 0; Landmark < Distances.Num(); ++Landmark)
+	{
+		const float CellDistance = Distances[Landmark][*CellIndex];
+		const float GoalDistance = GoalDistances[Landmark];
+		// 与地标不连通时该地标不提供信息
+		if (CellDistance == FlightNavLandmarks::Unreachable || GoalDistance == FlightNavLandmarks::Unreachable)
+		{
+			continue;
+		}
+		Bound = FMath::Max(Bound, FMath::Abs(GoalDistance - CellDistance));
+	}
+	return Bound;
+}
+
+bool FFlightNavLandmarks::PrepareGoalSet(TConstArrayView<FVector> GoalCells, TArray<float>& OutMinGoalDistances, TArray<float>& OutMaxGoalDistances) const
+{
+	OutMinGoalDistances.Reset();
+	OutMaxGoalDistances.Reset();
+	if (GoalCells.Num() == 0)
+	{
+		return false;
+	}
+
+	OutMinGoalDistances.Init(FlightNavLandmarks::Unreachable, Distances.Num());
+	OutMaxGoalDistances.Init(0.0f, Distances.Num());
+	for (const FVector& GoalCell : GoalCells)
+	{
+		const int32* GoalIndex = CellIndices.Find(GoalCell);
+		if (!GoalIndex)
+		{
+			OutMinGoalDistances.Reset();
+			OutMaxGoalDistances.Reset();
+			return false;
+		}
+
+		for (int32 Landmark = 0; Landmark < Distances.Num(); ++Landmark)
+		{
+			const float GoalDistance = Distances[Landmark][*GoalIndex];
+			// 任一终点与地标不连通时，该地标对整个集合都不提供信息
+			if (GoalDistance == FlightNavLandmarks::Unreachable || OutMaxGoalDistances[Landmark] == FlightNavLandmarks::Unreachable)
+			{
+				OutMinGoalDistances[Landmark] = FlightNavLandmarks::Unreachable;
+				OutMaxGoalDistances[Landmark] = FlightNavLandmarks::Unreachable;
+				continue;
+			}
+			OutMinGoalDistances[Landmark] = FMath::Min(OutMinGoalDistances[Landmark], GoalDistance);
+			OutMaxGoalDistances[Landmark] = FMath::Max(OutMaxGoalDistances[Landmark], GoalDistance);
+		}
+	}
+	return true;
+}
+
+float FFlightNavLandmarks::GetLowerBoundToSet(const FVector& Cell, TConstArrayView<float> MinGoalDistances, TConstArrayView<float> MaxGoalDistances) const
+{
+	if (MinGoalDistances.Num() != Distances.Num() || MaxGoalDistances.Num() != Distances.Num())
+	{
+		return 0.0f;
+	}
+
+	const int32* CellIndex = CellIndices.Find(Cell);
+	if (!CellIndex)
+	{
+		return 0.0f;
+	}
+
+	float Bound = 0.0f;
+	for (int32 Landmark = 0; Landmark < Distances.Num(); ++Landmark)
+	{
+		const float CellDistance = Distances[Landmark][*CellIndex];
+		if (CellDistance == FlightNavLandmarks::Unreachable || MaxGoalDistances[Landmark] == FlightNavLandmarks::Unreachable)
+		{
+			continue;
+		}
+		// 对每个终点 d(n, g) >= |d(L, g) - d(L, n)|，对集合取最小值后仍不小于这两项
+		Bound = FMath::Max(Bound, MinGoalDistances[Landmark] - CellDistance);
+		Bound = FMath::Max(Bound, CellDistance - MaxGoalDistances[Landmark]);
+	}
+	return Bound;
+}
+
+SIZE_T FFlightNavLandmarks::GetAllocatedSize() const
+{
+	SIZE_T Size = CellIndices.GetAllocatedSize() + LandmarkCells.GetAllocatedSize() + Distances.GetAllocatedSize();
+	for (const TArray<float>& LandmarkDistances : Distances)
+	{
+		Size += LandmarkDistances.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavNeighborKernel.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+namespace FlightNavNeighborKernel
+{
+	// 26 个方向，顺序与 GetNeighborGridCenters 一致
+	static const FIntVector Offsets[FFlightNavNeighborBatch::NumNeighbors] = {
+		FIntVector(1, 0, 0),
+		FIntVector(0, 1, 0),
+		FIntVector(0, 0, 1),
+		FIntVector(-1, 0, 0),
+		FIntVector(0, -1, 0),
+		FIntVector(0, 0, -1),
+
+		FIntVector(1, 1, 0),
+		FIntVector(1, 0, 1),
+		FIntVector(0, 1, 1),
+		FIntVector(-1, -1, 0),
+		FIntVector(-1, 0, -1),
+		FIntVector(0, -1, -1),
+		FIntVector(-1, 1, 0),
+		FIntVector(-1, 0, 1),
+		FIntVector(0, -1, 1),
+		FIntVector(1, -1, 0),
+		FIntVector(1, 0, -1),
+		FIntVector(0, 1, -1),
+
+		FIntVector(1, 1, 1),
+		FIntVector(-1, -1, -1),
+		FIntVector(-1, 1, 1),
+		FIntVector(1, -1, 1),
+		FIntVector(1, 1, -1),
+		FIntVector(-1, 1, -1),
+		FIntVector(1, -1, -1),
+		FIntVector(-1, -1, 1)
+	};
+
+	// 以 SoA 形式保存的偏移与单位步长代价（1 / √2 / √3），末尾两个为补齐
+	struct FOffsetTables
+	{
+		alignas(16) float X[FFlightNavNeighborBatch::PaddedNeighbors];
+		alignas(16) float Y[FFlightNavNeighborBatch::PaddedNeighbors];
+		alignas(16) float Z[FFlightNavNeighborBatch::PaddedNeighbors];
+		alignas(16) float StepCost[FFlightNavNeighborBatch::PaddedNeighbors];
+
+		FOffsetTables()
+		{
+			for (int32 Index = 0; Index < FFlightNavNeighborBatch::PaddedNeighbors; ++Index)
+			{
+				const FIntVector Offset = Index < FFlightNavNeighborBatch::NumNeighbors ? Offsets[Index] : FIntVector::ZeroValue;
+				X[Index] = static_cast<float>(Offset.X);
+				Y[Index] = static_cast<float>(Offset.Y);
+				Z[Index] = static_cast<float>(Offset.Z);
+				StepCost[Index] = FMath::Sqrt(static_cast<float>(Offset.X * Offset.X + Offset.Y * Offset.Y + Offset.Z * Offset.Z));
+			}
+		}
+	};
+
+	static const FOffsetTables& GetTables()
+	{
+		static const FOffsetTables Tables;
+		return Tables;
+	}
+
+	const FIntVector& GetOffset(int32 Index)
+	{
+		check(Index >= 0 && Index < FFlightNavNeighborBatch::NumNeighbors);
+		return Offsets[Index];
+	}
+
+	void Evaluate(const FIntVector& Cell, const FIntVector& GoalCell, float CurrentG, float NodeSize, FFlightNavNeighborBatch& OutBatch)
+	{
+		const FOffsetTables& Tables = GetTables();
+
+		// 当前格子到终点的整数差，邻居的差 = 该差 + 偏移
+		const VectorRegister4Float DeltaX = VectorSetFloat1(static_cast<float>(Cell.X - GoalCell.X));
+		const VectorRegister4Float DeltaY = VectorSetFloat1(static_cast<float>(Cell.Y - GoalCell.Y));
+		const VectorRegister4Float DeltaZ = VectorSetFloat1(static_cast<float>(Cell.Z - GoalCell.Z));
+		const VectorRegister4Float Size = VectorSetFloat1(NodeSize);
+		const VectorRegister4Float BaseG = VectorSetFloat1(CurrentG);
+
+		for (int32 Index = 0; Index < FFlightNavNeighborBatch::PaddedNeighbors; Index += 4)
+		{
+			const VectorRegister4Float X = VectorAdd(DeltaX, VectorLoadAligned(&Tables.X[Index]));
+			const VectorRegister4Float Y = VectorAdd(DeltaY, VectorLoadAligned(&Tables.Y[Index]));
+			const VectorRegister4Float Z = VectorAdd(DeltaZ, VectorLoadAligned(&Tables.Z[Index]));
+
+			const VectorRegister4Float LengthSquared = VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z)));
+			VectorStoreAligned(VectorMultiply(VectorSqrt(LengthSquared), Size), &OutBatch.H[Index]);
+			VectorStoreAligned(VectorMultiplyAdd(VectorLoadAligned(&Tables.StepCost[Index]), Size, BaseG), &OutBatch.G[Index]);
+		}
+	}
+
+	void EvaluateScalar(const FIntVector& Cell, const FIntVector& GoalCell, float CurrentG, float NodeSize, FFlightNavNeighborBatch& OutBatch)
+	{
+		const FOffsetTables& Tables = GetTables();
+		const FIntVector Delta = Cell - GoalCell;
+
+		for (int32 Index = 0; Index < FFlightNavNeighborBatch::PaddedNeighbors; ++Index)
+		{
+			const float X = static_cast<float>(Delta.X) + Tables.X[Index];
+			const float Y = static_cast<float>(Delta.Y) + Tables.Y[Index];
+			const float Z = static_cast<float>(Delta.Z) + Tables.Z[Index];
+			OutBatch.H[Index] = FMath::Sqrt(X * X + Y * Y + Z * Z) * NodeSize;
+			OutBatch.G[Index] = CurrentG + Tables.StepCost[Index] * NodeSize;
+		}
+	}
+}
+
+/*-----------基准测试-----------------*/
+static void RunNeighborKernelBenchmark(const TArray<FString>& Args)
+{
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+	const float NodeSize = 100.0f;
+	const FIntVector GoalCell(37, -12, 5);
+	const FVector GoalCenter = FlightNavNeighborKernel::ToCenter(GoalCell, NodeSize);
+
+	// 防止编译器把计算优化掉
+	double Sink = 0.0;
+
+	// 原始实现：生成邻居坐标数组，再逐个用双精度算距离和启发值
+	double StartSeconds = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const FVector Center = FlightNavNeighborKernel::ToCenter(FIntVector(Iteration & 63, (Iteration >> 6) & 63, Iteration >> 12), NodeSize);
+		for (const FVector& Neighbor : UFlightNavigationBFL::GetNeighborGridCenters(Center, NodeSize))
+		{
+			Sink += FVector::Dist(Center, Neighbor) + UFlightNavigationBFL::Heuristic(Neighbor, GoalCenter);
+		}
+	}
+	const double LegacyMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	FFlightNavNeighborBatch Batch;
+
+	StartSeconds = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const FIntVector Cell(Iteration & 63, (Iteration >> 6) & 63, Iteration >> 12);
+		FlightNavNeighborKernel::EvaluateScalar(Cell, GoalCell, 0.0f, NodeSize, Batch);
+		Sink += Batch.G[Iteration % FFlightNavNeighborBatch::NumNeighbors] + Batch.H[Iteration % FFlightNavNeighborBatch::NumNeighbors];
+	}
+	const double ScalarMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	StartSeconds = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const FIntVector Cell(Iteration & 63, (Iteration >> 6) & 63, Iteration >> 12);
+		FlightNavNeighborKernel::Evaluate(Cell, GoalCell, 0.0f, NodeSize, Batch);
+		Sink += Batch.G[Iteration % FFlightNavNeighborBatch::NumNeighbors] + Batch.H[Iteration % FFlightNavNeighborBatch::NumNeighbors];
+	}
+	const double VectorMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	// 校验向量化结果与标量结果一致
+	float MaxError = 0.0f;
+	FFlightNavNeighborBatch ScalarBatch;
+	for (int32 Iteration = 0; Iteration < 4096; ++Iteration)
+	{
+		const FIntVector Cell(Iteration & 15, (Iteration >> 4) & 15, Iteration >> 8);
+		FlightNavNeighborKernel::EvaluateScalar(Cell, GoalCell, 10.0f, NodeSize, ScalarBatch);
+		FlightNavNeighborKernel::Evaluate(Cell, GoalCell, 10.0f, NodeSize, Batch);
+		for (int32 Index = 0; Index < FFlightNavNeighborBatch::NumNeighbors; ++Index)
+		{
+			MaxError = FMath::Max(MaxError, FMath::Abs(ScalarBatch.G[Index] - Batch.G[Index]));
+			MaxError = FMath::Max(MaxError, FMath::Abs(ScalarBatch.H[Index] - Batch.H[Index]));
+		}
+	}
+
+	// 分开报告两部分收益：整数格子 + SoA 表（legacy -> scalar）与 SIMD 本身（scalar -> vector）
+	const double NsPerExpansion = 1.0e6 / Iterations;
+	UE_LOG(LogFlightNav, Display, TEXT("NeighborKernel x%d: legacy %.3f ms (%.1f ns/node), scalar %.3f ms (%.1f ns/node), vector %.3f ms (%.1f ns/node)"),
+		Iterations,
+		LegacyMs, LegacyMs * NsPerExpansion,
+		ScalarMs, ScalarMs * NsPerExpansion,
+		VectorMs, VectorMs * NsPerExpansion);
+	UE_LOG(LogFlightNav, Display, TEXT("NeighborKernel speedup: scalar vs legacy %.2fx, vector vs scalar %.2fx, max error %g (sink %g)"),
+		ScalarMs > 0.0 ? LegacyMs / ScalarMs : 0.0,
+		VectorMs > 0.0 ? ScalarMs / VectorMs : 0.0,
+		MaxError, Sink);
+}
+
+static FAutoConsoleCommand GFlightNavNeighborKernelBenchmarkCommand(
+	TEXT("FlightNav.Bench.NeighborKernel"),
+	TEXT("对比邻居展开的原始实现、标量实现与向量化实现的耗时。参数：迭代次数（默认 100000）"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunNeighborKernelBenchmark));
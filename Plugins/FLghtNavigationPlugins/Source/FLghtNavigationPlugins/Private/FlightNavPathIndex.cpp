@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavPathIndex.h"
+#include "FlightNavNeighborKernel.h"
+
+int32 FFlightNavPathIndex::Subscribe(uint32 GridId, float NodeSize, TConstArrayView<FVector> Path, FOnFlightNavPathInvalidatedNative OnInvalidated)
+{
+	if (Path.Num() == 0 || NodeSize <= 0.0f)
+	{
+		return INDEX_NONE;
+	}
+
+	if (!OnInvalidated.IsBound())
+	{
+		return INDEX_NONE;
+	}
+
+	// 在锁外换算格子；同一格子只记一条，记录第一次经过时的路径点和经过的点数（原地等待会重复）
+	FSubscription Subscription;
+	Subscription.GridId = GridId;
+	Subscription.NumPoints = Path.Num();
+	Subscription.OnInvalidated = MoveTemp(OnInvalidated);
+	TArray<FEntry> Entries;
+	TMap<FIntVector, int32> CellSlots;
+	CellSlots.Reserve(Path.Num());
+	for (int32 PointIndex = 0; PointIndex < Path.Num(); ++PointIndex)
+	{
+		const FIntVector Cell = FlightNavNeighborKernel::ToCell(Path[PointIndex], NodeSize);
+		if (const int32* Slot = CellSlots.Find(Cell))
+		{
+			++Entries[*Slot].NumPoints;
+			continue;
+		}
+		CellSlots.Add(Cell, Entries.Num());
+		Subscription.Cells.Add(Cell);
+		Entries.Add({ INDEX_NONE, PointIndex, 1 });
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (Subscriptions.Num() >= PruneThreshold)
+	{
+		PruneUnboundLocked();
+		PruneThreshold = FMath::Max(64, Subscriptions.Num() * 2);
+	}
+
+	const int32 SubscriptionId = NextSubscriptionId++;
+	for (int32 Index = 0; Index < Subscription.Cells.Num(); ++Index)
+	{
+		Entries[Index].SubscriptionId = SubscriptionId;
+		CellEntries.FindOrAdd({ GridId, Subscription.Cells[Index] }).Add(Entries[Index]);
+	}
+	Subscriptions.Add(SubscriptionId, MoveTemp(Subscription));
+	return SubscriptionId;
+}
+
+void FFlightNavPathIndex::Unsubscribe(int32 SubscriptionId)
+{
+	FWriteScopeLock WriteLock(Lock);
+	RemoveLocked(SubscriptionId, nullptr);
+}
+
+bool FFlightNavPathIndex::RemoveLocked(int32 SubscriptionId, FOnFlightNavPathInvalidatedNative* OutDelegate)
+{
+	FSubscription Subscription;
+	if (!Subscriptions.RemoveAndCopyValue(SubscriptionId, Subscription))
+	{
+		return false;
+	}
+
+	for (const FIntVector& Cell : Subscription.Cells)
+	{
+		const FCellKey Key{ Subscription.GridId, Cell };
+		if (TArray<FEntry>* Entries = CellEntries.Find(Key))
+		{
+			Entries->RemoveAllSwap([SubscriptionId](const FEntry& Entry) { return Entry.SubscriptionId == SubscriptionId; }, EAllowShrinking::No);
+			if (Entries->Num() == 0)
+			{
+				CellEntries.Remove(Key);
+			}
+		}
+	}
+
+	if (OutDelegate)
+	{
+		*OutDelegate = MoveTemp(Subscription.OnInvalidated);
+	}
+	return true;
+}
+
+void FFlightNavPathIndex::PruneUnboundLocked()
+{
+	TArray<int32> Unbound;
+	for (const TPair<int32, FSubscription>& Pair : Subscriptions)
+	{
+		if (!Pair.Value.OnInvalidated.IsBound())
+		{
+			Unbound.Add(Pair.Key);
+		}
+	}
+	for (const int32 SubscriptionId : Unbound)
+	{
+		RemoveLocked(SubscriptionId, nullptr);
+	}
+}
+
+void FFlightNavPathIndex::CollectAffected(uint32 GridId, TConstArrayView<FIntVector> Cells, TMap<int32, FFlightNavPathInvalidation>& OutAffected) const
+{
+	FReadScopeLock ReadLock(Lock);
+	if (CellEntries.Num() == 0)
+	{
+		return;
+	}
+
+	for (const FIntVector& Cell : Cells)
+	{
+		const TArray<FEntry>* Entries = CellEntries.Find({ GridId, Cell });
+		if (!Entries)
+		{
+			continue;
+		}
+
+		for (const FEntry& Entry : *Entries)
+		{
+			FFlightNavPathInvalidation& Invalidation = OutAffected.FindOrAdd(Entry.SubscriptionId);
+			if (Invalidation.SubscriptionId == INDEX_NONE)
+			{
+				Invalidation.SubscriptionId = Entry.SubscriptionId;
+				Invalidation.FirstInvalidIndex = Entry.PointIndex;
+			}
+			Invalidation.FirstInvalidIndex = FMath::Min(Invalidation.FirstInvalidIndex, Entry.PointIndex);
+			Invalidation.NumInvalidPoints += Entry.NumPoints;
+		}
+	}
+}
+
+void FFlightNavPathIndex::Invalidate(const TMap<int32, FFlightNavPathInvalidation>& Affected)
+{
+	if (Affected.Num() == 0)
+	{
+		return;
+	}
+
+	// 先在锁内移除，再在锁外回调，回调中可以重新订阅
+	TArray<TPair<FOnFlightNavPathInvalidatedNative, FFlightNavPathInvalidation>> Notifications;
+	{
+		FWriteScopeLock WriteLock(Lock);
+		for (const TPair<int32, FFlightNavPathInvalidation>& Pair : Affected)
+		{
+			FOnFlightNavPathInvalidatedNative Delegate;
+			if (RemoveLocked(Pair.Key, &Delegate) && Delegate.IsBound())
+			{
+				Notifications.Emplace(MoveTemp(Delegate), Pair.Value);
+			}
+		}
+	}
+
+	for (const TPair<FOnFlightNavPathInvalidatedNative, FFlightNavPathInvalidation>& Notification : Notifications)
+	{
+		Notification.Key.ExecuteIfBound(Notification.Value);
+	}
+}
+
+void FFlightNavPathIndex::InvalidateGrid(uint32 GridId)
+{
+	TMap<int32, FFlightNavPathInvalidation> Affected;
+	{
+		FReadScopeLock ReadLock(Lock);
+		for (const TPair<int32, FSubscription>& Pair : Subscriptions)
+		{
+			if (Pair.Value.GridId == GridId)
+			{
+				FFlightNavPathInvalidation& Invalidation = Affected.Add(Pair.Key);
+				Invalidation.SubscriptionId = Pair.Key;
+				Invalidation.FirstInvalidIndex = 0;
+				Invalidation.NumInvalidPoints = Pair.Value.NumPoints;
+			}
+		}
+	}
+	Invalidate(Affected);
+}
+
+int32 FFlightNavPathIndex::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Subscriptions.Num();
+}
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavRaycast.h"
+#include "FlightNavNeighborKernel.h"
+#include "FlightNavStats.h"
+#include "OctreeFlightComponent.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "UObject/UObjectIterator.h"
+
+namespace FlightNavRaycast
+{
+	// 与 FindPath 的可通行判断一致：网格中不可通行，或（按需）不在网格中
+	static FORCEINLINE bool IsBlocked(const TMap<FVector, FAStarNode>& GridNodes, const FIntVector& Cell, float NodeSize, bool bTreatMissingAsBlocked)
+	{
+		const FAStarNode* Node = GridNodes.Find(FlightNavNeighborKernel::ToCenter(Cell, NodeSize));
+		return Node ? !Node->bIsWalkable : bTreatMissingAsBlocked;
+	}
+
+	// 分块并行执行，每块 SegmentsPerTask 条线段
+	template <typename FuncType>
+	static void ForEachSegment(int32 NumSegments, FuncType&& Func)
+	{
+		const int32 NumTasks = FMath::DivideAndRoundUp(NumSegments, FFlightNavRaycast::SegmentsPerTask);
+		ParallelFor(NumTasks, [NumSegments, &Func](int32 TaskIndex)
+		{
+			const int32 First = TaskIndex * FFlightNavRaycast::SegmentsPerTask;
+			const int32 Last = FMath::Min(First + FFlightNavRaycast::SegmentsPerTask, NumSegments);
+			for (int32 Index = First; Index < Last; ++Index)
+			{
+				Func(Index);
+			}
+		}, NumTasks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+}
+
+bool FFlightNavRaycast::Trace(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize,
+	const FVector& Start, const FVector& End, bool bTreatMissingAsBlocked, FFlightNavRayHit& OutHit)
+{
+	OutHit = FFlightNavRayHit();
+	OutHit.Location = End;
+
+	if (NodeSize <= 0.0f)
+	{
+		return false;
+	}
+
+	const FVector Delta = End - Start;
+	FIntVector Cell = FlightNavNeighborKernel::ToCell(Start, NodeSize);
+	const FIntVector EndCell = FlightNavNeighborKernel::ToCell(End, NodeSize);
+
+	// t 为线段参数（0 = 起点，1 = 终点）；TMax 为下一次穿过各轴格子边界时的 t，TDelta 为穿过一整格的 t
+	int32 Step[3];
+	double TMax[3];
+	double TDelta[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const double D = Delta[Axis];
+		if (D > 0.0)
+		{
+			Step[Axis] = 1;
+			TDelta[Axis] = NodeSize / D;
+			TMax[Axis] = ((Cell[Axis] + 1) * static_cast<double>(NodeSize) - Start[Axis]) / D;
+		}
+		else if (D < 0.0)
+		{
+			Step[Axis] = -1;
+			TDelta[Axis] = NodeSize / -D;
+			TMax[Axis] = (Cell[Axis] * static_cast<double>(NodeSize) - Start[Axis]) / D;
+		}
+		else
+		{
+			Step[Axis] = 0;
+			TDelta[Axis] = TNumericLimits<double>::Max();
+			TMax[Axis] = TNumericLimits<double>::Max();
+		}
+	}
+
+	// 线段恰好经过的格子数，作为循环上限，防止浮点误差导致越过终点
+	const int32 MaxCells = FMath::Abs(EndCell.X - Cell.X) + FMath::Abs(EndCell.Y - Cell.Y) + FMath::Abs(EndCell.Z - Cell.Z) + 1;
+
+	double TEntry = 0.0;
+	for (int32 Visited = 0; Visited < MaxCells; ++Visited)
+	{
+		if (FlightNavRaycast::IsBlocked(GridNodes, Cell, NodeSize, bTreatMissingAsBlocked))
+		{
+			OutHit.bBlockingHit = true;
+			OutHit.Location = Start + Delta * TEntry;
+			OutHit.CellCenter = FlightNavNeighborKernel::ToCenter(Cell, NodeSize);
+			OutHit.Distance = static_cast<float>(Delta.Size() * TEntry);
+			return true;
+		}
+
+		// 以到达终点格子为结束条件，不比较 t > 1，避免终点恰在格子边界时因舍入漏掉最后一格
+		if (Cell == EndCell)
+		{
+			break;
+		}
+
+		const int32 Axis = TMax[0] < TMax[1]
+			? (TMax[0] < TMax[2] ? 0 : 2)
+			: (TMax[1] < TMax[2] ? 1 : 2);
+		TEntry = FMath::Min(TMax[Axis], 1.0);
+		Cell[Axis] += Step[Axis];
+		TMax[Axis] += TDelta[Axis];
+	}
+
+	OutHit.Distance = static_cast<float>(Delta.Size());
+	return false;
+}
+
+void FFlightNavRaycast::TraceBatch(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize,
+	TConstArrayView<FFlightNavRaySegment> Segments, bool bTreatMissingAsBlocked, TArray<FFlightNavRayHit>& OutHits)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_RaycastBatch);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_Raycast);
+
+	OutHits.SetNum(Segments.Num());
+	FlightNavRaycast::ForEachSegment(Segments.Num(), [&](int32 Index)
+	{
+		Trace(GridNodes, NodeSize, Segments[Index].Start, Segments[Index].End, bTreatMissingAsBlocked, OutHits[Index]);
+	});
+}
+
+void FFlightNavRaycast::LineOfSightBatch(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize,
+	TConstArrayView<FFlightNavRaySegment> Segments, bool bTreatMissingAsBlocked, TArray<bool>& OutVisible)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_LineOfSightBatch);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_Raycast);
+
+	OutVisible.SetNum(Segments.Num());
+	FlightNavRaycast::ForEachSegment(Segments.Num(), [&](int32 Index)
+	{
+		FFlightNavRayHit Hit;
+		OutVisible[Index] = !Trace(GridNodes, NodeSize, Segments[Index].Start, Segments[Index].End, bTreatMissingAsBlocked, Hit);
+	});
+}
+
+/*-----------基准测试-----------------*/
+static void RunRaycastBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	const int32 NumSegments = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+
+	FFlightNavDataHandle NavData;
+	for (TObjectIterator<UOctreeFlightComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && It->GetNavDataHandle().IsValid())
+		{
+			NavData = It->GetNavDataHandle();
+			break;
+		}
+	}
+	if (!World || !NavData.IsValid())
+	{
+		UE_LOG(LogFlightNav, Warning, TEXT("FlightNav.Bench.Raycast: no baked UOctreeFlightComponent in this world."));
+		return;
+	}
+
+	// 固定种子，多次运行结果可比
+	const FBox Bounds = NavData.GetBounds();
+	FRandomStream Random(1337);
+	TArray<FFlightNavRaySegment> Segments;
+	Segments.SetNum(NumSegments);
+	for (FFlightNavRaySegment& Segment : Segments)
+	{
+		Segment.Start = Random.RandPointInBox(Bounds);
+		Segment.End = Random.RandPointInBox(Bounds);
+	}
+
+	double StartSeconds = FPlatformTime::Seconds();
+	int32 PhysicsBlocked = 0;
+	for (const FFlightNavRaySegment& Segment : Segments)
+	{
+		FHitResult Hit;
+		PhysicsBlocked += World->LineTraceSingleByChannel(Hit, Segment.Start, Segment.End, ECC_Visibility) ? 1 : 0;
+	}
+	const double PhysicsMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	StartSeconds = FPlatformTime::Seconds();
+	TArray<bool> Visible;
+	FFlightNavRaycast::LineOfSightBatch(*NavData.GetGrid(), NavData.GetNodeSize(), Segments, false, Visible);
+	const double VoxelMs = (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+
+	int32 VoxelBlocked = 0;
+	for (const bool bVisible : Visible)
+	{
+		VoxelBlocked += bVisible ? 0 : 1;
+	}
+
+	UE_LOG(LogFlightNav, Display, TEXT("Raycast x%d: physics %.3f ms (%d blocked), voxel DDA %.3f ms (%d blocked), speedup %.2fx"),
+		NumSegments, PhysicsMs, PhysicsBlocked, VoxelMs, VoxelBlocked, VoxelMs > 0.0 ? PhysicsMs / VoxelMs : 0.0);
+}
+
+static FAutoConsoleCommand GFlightNavRaycastBenchmarkCommand(
+	TEXT("FlightNav.Bench.Raycast"),
+	TEXT("对比 LineTraceSingleByChannel 与体素 DDA 批量视线检测的耗时。参数：线段数（默认 10000）"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunRaycastBenchmark));
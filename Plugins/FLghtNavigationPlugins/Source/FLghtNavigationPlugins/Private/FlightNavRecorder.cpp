@@ -0,0 +1,374 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavRecorder.h"
+#include "FlightNavNeighborKernel.h"
+#include "OctreeFlightComponent.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace FlightNavRecording
+{
+	// 每写入这么多事件刷新一次文件，异常退出时最多丢失这部分
+	static constexpr int32 FlushInterval = 256;
+
+	FArchive& operator<<(FArchive& Ar, FEventHeader& Header)
+	{
+		uint8 Type = static_cast<uint8>(Header.Type);
+		Ar << Type << Header.TimeSeconds << Header.StreamId;
+		Header.Type = static_cast<EEventType>(Type);
+		return Ar;
+	}
+
+	FArchive& operator<<(FArchive& Ar, FGridSnapshotEvent& Event)
+	{
+		return Ar << Event.SnapshotFile << Event.Crc << Event.NodeSize << Event.NumLandmarks;
+	}
+
+	FArchive& operator<<(FArchive& Ar, FCellsChangedEvent& Event)
+	{
+		return Ar << Event.bIsWalkable << Event.Cells;
+	}
+
+	FArchive& operator<<(FArchive& Ar, FPathQueryEvent& Event)
+	{
+		return Ar << Event.Start << Event.Goal << Event.PathPoints << Event.PathHash << Event.NodesExpanded << Event.WallTimeMs;
+	}
+
+	FArchive& operator<<(FArchive& Ar, FGridSnapshot& Snapshot)
+	{
+		return Ar << Snapshot.NodeSize << Snapshot.MinCell << Snapshot.Dimensions << Snapshot.Present << Snapshot.Walkable;
+	}
+
+	uint32 HashPath(TConstArrayView<FVector> Path)
+	{
+		return FCrc::MemCrc32(Path.GetData(), Path.Num() * sizeof(FVector));
+	}
+
+	bool FGridSnapshot::FromGrid(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize, FGridSnapshot& OutSnapshot)
+	{
+		FGridSnapshot& Snapshot = OutSnapshot;
+		Snapshot = FGridSnapshot();
+		Snapshot.NodeSize = NodeSize;
+		if (GridNodes.Num() == 0 || NodeSize <= 0.0f)
+		{
+			return true;
+		}
+
+		FIntVector MinCell(MAX_int32);
+		FIntVector MaxCell(MIN_int32);
+		for (const TPair<FVector, FAStarNode>& Voxel : GridNodes)
+		{
+			const FIntVector Cell = FlightNavNeighborKernel::ToCell(Voxel.Key, NodeSize);
+			MinCell = FIntVector(FMath::Min(MinCell.X, Cell.X), FMath::Min(MinCell.Y, Cell.Y), FMath::Min(MinCell.Z, Cell.Z));
+			MaxCell = FIntVector(FMath::Max(MaxCell.X, Cell.X), FMath::Max(MaxCell.Y, Cell.Y), FMath::Max(MaxCell.Z, Cell.Z));
+		}
+
+		// 稀疏网格的包围范围可能远大于格子数，先用 int64 检查
+		const int64 SizeX = int64(MaxCell.X) - MinCell.X + 1;
+		const int64 SizeY = int64(MaxCell.Y) - MinCell.Y + 1;
+		const int64 SizeZ = int64(MaxCell.Z) - MinCell.Z + 1;
+		if (SizeX > MaxSnapshotCells || SizeY > MaxSnapshotCells || SizeZ > MaxSnapshotCells ||
+			SizeX * SizeY > MaxSnapshotCells || SizeX * SizeY * SizeZ > MaxSnapshotCells)
+		{
+			UE_LOG(LogFlightNav, Error, TEXT("Grid snapshot bounds %lld x %lld x %lld exceed %lld cells."), SizeX, SizeY, SizeZ, MaxSnapshotCells);
+			Snapshot = FGridSnapshot();
+			return false;
+		}
+
+		Snapshot.MinCell = MinCell;
+		Snapshot.Dimensions = FIntVector(SizeX, SizeY, SizeZ);
+		const int32 NumCells = static_cast<int32>(SizeX * SizeY * SizeZ);
+		Snapshot.Present.Init(false, NumCells);
+		Snapshot.Walkable.Init(false, NumCells);
+
+		for (const TPair<FVector, FAStarNode>& Voxel : GridNodes)
+		{
+			const FIntVector Local = FlightNavNeighborKernel::ToCell(Voxel.Key, NodeSize) - MinCell;
+			const int32 Index = (Local.X * Snapshot.Dimensions.Y + Local.Y) * Snapshot.Dimensions.Z + Local.Z;
+			Snapshot.Present[Index] = true;
+			Snapshot.Walkable[Index] = Voxel.Value.bIsWalkable;
+		}
+		return true;
+	}
+
+	void FGridSnapshot::ToGrid(TMap<FVector, FAStarNode>& OutGrid) const
+	{
+		OutGrid.Reset();
+		OutGrid.Reserve(Present.CountSetBits());
+
+		// 按 X、Y、Z 顺序插入，与烘焙时的插入顺序一致
+		int32 Index = 0;
+		for (int32 X = 0; X < Dimensions.X; ++X)
+		{
+			for (int32 Y = 0; Y < Dimensions.Y; ++Y)
+			{
+				for (int32 Z = 0; Z < Dimensions.Z; ++Z, ++Index)
+				{
+					if (Present[Index])
+					{
+						const FVector Center = FlightNavNeighborKernel::ToCenter(MinCell + FIntVector(X, Y, Z), NodeSize);
+						OutGrid.Add(Center, FAStarNode(Center, NodeSize, Walkable[Index]));
+					}
+				}
+			}
+		}
+	}
+
+	void FGridSnapshot::SetWalkable(const FIntVector& Cell, bool bWalkable)
+	{
+		const FIntVector Local = Cell - MinCell;
+		if (Local.X < 0 || Local.Y < 0 || Local.Z < 0 || Local.X >= Dimensions.X || Local.Y >= Dimensions.Y || Local.Z >= Dimensions.Z)
+		{
+			return;
+		}
+		const int32 Index = (Local.X * Dimensions.Y + Local.Y) * Dimensions.Z + Local.Z;
+		if (Present[Index])
+		{
+			Walkable[Index] = bWalkable;
+		}
+	}
+
+	void FGridSnapshot::SaveToBytes(TArray<uint8>& OutBytes) const
+	{
+		OutBytes.Reset();
+		FMemoryWriter Writer(OutBytes);
+		uint32 Magic = SnapshotMagic;
+		uint32 FileVersion = Version;
+		Writer << Magic << FileVersion;
+		Writer << const_cast<FGridSnapshot&>(*this);
+	}
+
+	bool FGridSnapshot::LoadFromBytes(const TArray<uint8>& Bytes)
+	{
+		FMemoryReader Reader(Bytes);
+		uint32 Magic = 0;
+		uint32 FileVersion = 0;
+		Reader << Magic << FileVersion;
+		if (Magic != SnapshotMagic || FileVersion != Version)
+		{
+			return false;
+		}
+
+		Reader << *this;
+		if (Reader.IsError() || Dimensions.X < 0 || Dimensions.Y < 0 || Dimensions.Z < 0)
+		{
+			return false;
+		}
+		const int64 NumCells = int64(Dimensions.X) * Dimensions.Y * Dimensions.Z;
+		return NumCells <= MaxSnapshotCells && Present.Num() == NumCells && Walkable.Num() == NumCells;
+	}
+}
+
+std::atomic<bool> FFlightNavRecorder::bRecording(false);
+
+FFlightNavRecorder& FFlightNavRecorder::Get()
+{
+	static FFlightNavRecorder Instance;
+	return Instance;
+}
+
+bool FFlightNavRecorder::Start(const FString& FilePath)
+{
+	FScopeLock Lock(&RecorderCriticalSection);
+	if (Writer)
+	{
+		UE_LOG(LogFlightNav, Warning, TEXT("FlightNav recorder is already writing %s."), *LogFilePath);
+		return false;
+	}
+
+	LogFilePath = FilePath.IsEmpty()
+		? FPaths::ProfilingDir() / TEXT("FlightNav") / FString::Printf(TEXT("FlightNav-%s.fnrec"), *FDateTime::Now().ToString())
+		: FilePath;
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*LogFilePath));
+	if (!Writer)
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("FlightNav recorder could not open %s."), *LogFilePath);
+		return false;
+	}
+
+	uint32 Magic = FlightNavRecording::LogMagic;
+	uint32 FileVersion = FlightNavRecording::Version;
+	*Writer << Magic << FileVersion;
+
+	StartSeconds = FPlatformTime::Seconds();
+	NumSnapshots = 0;
+	NumEvents = 0;
+	StreamsWithSnapshot.Reset();
+	bRecording.store(true);
+
+	UE_LOG(LogFlightNav, Display, TEXT("FlightNav recording to %s."), *LogFilePath);
+	return true;
+}
+
+void FFlightNavRecorder::Stop()
+{
+	FScopeLock Lock(&RecorderCriticalSection);
+	bRecording.store(false);
+	if (!Writer)
+	{
+		return;
+	}
+
+	Writer->Close();
+	Writer.Reset();
+	UE_LOG(LogFlightNav, Display, TEXT("FlightNav recording stopped: %d events, %d grid snapshots in %s."),
+		NumEvents, NumSnapshots, *LogFilePath);
+}
+
+void FFlightNavRecorder::RecordBake(const UOctreeFlightComponent& Component)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	FScopeLock Lock(&RecorderCriticalSection);
+	if (Writer)
+	{
+		WriteSnapshot(Component);
+	}
+}
+
+void FFlightNavRecorder::RecordCellsChanged(const UOctreeFlightComponent& Component, TConstArrayView<FAStarNode*> Nodes, bool bIsWalkable)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	FlightNavRecording::FCellsChangedEvent Event;
+	Event.bIsWalkable = bIsWalkable;
+	Event.Cells.Reserve(Nodes.Num());
+	for (const FAStarNode* Node : Nodes)
+	{
+		Event.Cells.Add(FlightNavNeighborKernel::ToCell(Node->Location, Component.NodeSize));
+	}
+
+	FScopeLock Lock(&RecorderCriticalSection);
+	if (Writer)
+	{
+		BeginEvent(Component, FlightNavRecording::EEventType::CellsChanged);
+		*Writer << Event;
+	}
+}
+
+void FFlightNavRecorder::RecordPathQuery(const UOctreeFlightComponent& Component, const FVector& Start, const FVector& Goal,
+	TConstArrayView<FVector> Path, const FFlightNavQueryStats& Stats)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	FlightNavRecording::FPathQueryEvent Event;
+	Event.Start = Start;
+	Event.Goal = Goal;
+	Event.PathPoints = Path.Num();
+	Event.PathHash = FlightNavRecording::HashPath(Path);
+	Event.NodesExpanded = Stats.NodesExpanded;
+	Event.WallTimeMs = Stats.WallTimeMs;
+
+	FScopeLock Lock(&RecorderCriticalSection);
+	if (Writer)
+	{
+		BeginEvent(Component, FlightNavRecording::EEventType::PathQuery);
+		*Writer << Event;
+	}
+}
+
+void FFlightNavRecorder::BeginEvent(const UOctreeFlightComponent& Component, FlightNavRecording::EEventType Type)
+{
+	// 开始录制时已经烘焙好的组件，先补一份快照
+	if (!StreamsWithSnapshot.Contains(Component.GetUniqueID()))
+	{
+		WriteSnapshot(Component);
+	}
+
+	FlightNavRecording::FEventHeader Header;
+	Header.Type = Type;
+	Header.TimeSeconds = FPlatformTime::Seconds() - StartSeconds;
+	Header.StreamId = Component.GetUniqueID();
+	*Writer << Header;
+
+	if (++NumEvents % FlightNavRecording::FlushInterval == 0)
+	{
+		Writer->Flush();
+	}
+}
+
+void FFlightNavRecorder::WriteSnapshot(const UOctreeFlightComponent& Component)
+{
+	// 无法保存的网格也记为已处理，避免之后每个事件都重试；重放时跳过该组件的查询
+	StreamsWithSnapshot.Add(Component.GetUniqueID());
+	FlightNavRecording::FGridSnapshot Snapshot;
+	if (!FlightNavRecording::FGridSnapshot::FromGrid(Component.VoxelGrids, Component.NodeSize, Snapshot))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("FlightNav recorder skipped the grid of %s, it is too large for a snapshot."), *Component.GetPathName());
+		return;
+	}
+
+	// 快照总是保存烘焙时（禁飞盒生效之前）的网格，重放时据此构建的地标与运行时一致；
+	// 录制开始时已关闭的禁飞盒随后作为一个 CellsChanged 事件写入
+	TArray<const FAStarNode*> BanClosedVoxels;
+	Component.GetBanClosedVoxels(BanClosedVoxels);
+	FlightNavRecording::FCellsChangedEvent BanClosed;
+	BanClosed.bIsWalkable = false;
+	BanClosed.Cells.Reserve(BanClosedVoxels.Num());
+	for (const FAStarNode* Voxel : BanClosedVoxels)
+	{
+		const FIntVector Cell = FlightNavNeighborKernel::ToCell(Voxel->Location, Component.NodeSize);
+		Snapshot.SetWalkable(Cell, true);
+		BanClosed.Cells.Add(Cell);
+	}
+	TArray<uint8> Bytes;
+	Snapshot.SaveToBytes(Bytes);
+
+	FlightNavRecording::FGridSnapshotEvent Event;
+	Event.SnapshotFile = FString::Printf(TEXT("%s_%d.fnsnap"), *FPaths::GetBaseFilename(LogFilePath), NumSnapshots);
+	Event.Crc = FCrc::MemCrc32(Bytes.GetData(), Bytes.Num());
+	Event.NodeSize = Component.NodeSize;
+	Event.NumLandmarks = Component.NumLandmarks;
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *(FPaths::GetPath(LogFilePath) / Event.SnapshotFile)))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("FlightNav recorder could not write snapshot %s."), *Event.SnapshotFile);
+	}
+	++NumSnapshots;
+
+	FlightNavRecording::FEventHeader Header;
+	Header.Type = FlightNavRecording::EEventType::GridSnapshot;
+	Header.TimeSeconds = FPlatformTime::Seconds() - StartSeconds;
+	Header.StreamId = Component.GetUniqueID();
+	*Writer << Header << Event;
+	++NumEvents;
+
+	if (BanClosed.Cells.Num() > 0)
+	{
+		Header.Type = FlightNavRecording::EEventType::CellsChanged;
+		*Writer << Header << BanClosed;
+		++NumEvents;
+	}
+}
+
+/*-----------控制台命令-----------------*/
+static FAutoConsoleCommand GFlightNavRecordStartCommand(
+	TEXT("FlightNav.Record.Start"),
+	TEXT("开始录制寻路查询与禁飞盒变化。参数：录制文件路径（可选，默认 Saved/Profiling/FlightNav）"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FFlightNavRecorder::Get().Start(Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+static FAutoConsoleCommand GFlightNavRecordStopCommand(
+	TEXT("FlightNav.Record.Stop"),
+	TEXT("停止录制并关闭录制文件"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FFlightNavRecorder::Get().Stop();
+	}));
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavReplayCommandlet.h"
+#include "FlightNavReplayer.h"
+
+UFlightNavReplayCommandlet::UFlightNavReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UFlightNavReplayCommandlet::Main(const FString& Params)
+{
+	FString LogFile;
+	if (!FParse::Value(*Params, TEXT("Log="), LogFile))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Usage: -run=FlightNavReplay -Log=<Recording.fnrec> [-Repeat=N] [-Csv=<Output.csv>]"));
+		return 1;
+	}
+
+	int32 Repeat = 1;
+	FParse::Value(*Params, TEXT("Repeat="), Repeat);
+
+	FString Error;
+	FFlightNavReplayer Replayer;
+	TArray<FFlightNavReplayQueryResult> Results;
+	if (!Replayer.Load(LogFile, Error) || !Replayer.Run(Repeat, Results, Error))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Replay failed: %s"), *Error);
+		return 1;
+	}
+
+	FFlightNavReplayer::LogSummary(Results);
+
+	FString CsvFile;
+	if (FParse::Value(*Params, TEXT("Csv="), CsvFile) && !FFlightNavReplayer::WriteCsv(Results, CsvFile))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Replay: cannot write %s"), *CsvFile);
+		return 1;
+	}
+
+	return Results.ContainsByPredicate([](const FFlightNavReplayQueryResult& Result) { return Result.IsMismatch(); }) ? 2 : 0;
+}
@@ -0,0 +1,279 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavReplayer.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavLandmarks.h"
+#include "FlightNavNeighborKernel.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+namespace FlightNavReplayer
+{
+	// 一个导航组件在重放中的状态
+	struct FStream
+	{
+		TMap<FVector, FAStarNode> Grid;
+		float NodeSize = 0.0f;
+		FFlightNavLandmarks Landmarks;
+	};
+
+	static float Percentile(const TArray<float>& SortedSamples, float Fraction)
+	{
+		if (SortedSamples.Num() == 0)
+		{
+			return 0.0f;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+}
+
+bool FFlightNavReplayer::Load(const FString& LogFilePath, FString& OutError)
+{
+	Events.Reset();
+	LogDirectory = FPaths::GetPath(LogFilePath);
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *LogFilePath))
+	{
+		OutError = FString::Printf(TEXT("cannot read %s"), *LogFilePath);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint32 FileVersion = 0;
+	Reader << Magic << FileVersion;
+	if (Magic != FlightNavRecording::LogMagic || FileVersion != FlightNavRecording::Version)
+	{
+		OutError = FString::Printf(TEXT("%s is not a version %u FlightNav recording"), *LogFilePath, FlightNavRecording::Version);
+		return false;
+	}
+
+	while (!Reader.AtEnd())
+	{
+		FEvent Event;
+		Reader << Event.Header;
+		switch (Event.Header.Type)
+		{
+		case FlightNavRecording::EEventType::GridSnapshot:
+			Reader << Event.Snapshot;
+			break;
+		case FlightNavRecording::EEventType::CellsChanged:
+			Reader << Event.CellsChanged;
+			break;
+		case FlightNavRecording::EEventType::PathQuery:
+			Reader << Event.Query;
+			break;
+		default:
+			OutError = FString::Printf(TEXT("unknown event type %d at offset %lld"), static_cast<int32>(Event.Header.Type), Reader.Tell());
+			return false;
+		}
+
+		// 录制过程中进程退出时最后一个事件可能不完整，丢弃即可
+		if (Reader.IsError())
+		{
+			UE_LOG(LogFlightNav, Warning, TEXT("Replay: %s ends with a truncated event, ignoring it."), *LogFilePath);
+			break;
+		}
+		Events.Add(MoveTemp(Event));
+	}
+	return true;
+}
+
+bool FFlightNavReplayer::Run(int32 Repeat, TArray<FFlightNavReplayQueryResult>& OutResults, FString& OutError) const
+{
+	OutResults.Reset();
+	Repeat = FMath::Max(Repeat, 1);
+	// 在游戏中通过控制台重放时，不能把重放的查询混进运行时的耗时统计
+	FFlightNavMetrics::FScopedSuppress SuppressMetrics;
+
+	TMap<uint32, FlightNavReplayer::FStream> Streams;
+	for (const FEvent& Event : Events)
+	{
+		switch (Event.Header.Type)
+		{
+		case FlightNavRecording::EEventType::GridSnapshot:
+		{
+			const FString SnapshotPath = LogDirectory / Event.Snapshot.SnapshotFile;
+			TArray<uint8> Bytes;
+			if (!FFileHelper::LoadFileToArray(Bytes, *SnapshotPath))
+			{
+				OutError = FString::Printf(TEXT("cannot read snapshot %s"), *SnapshotPath);
+				return false;
+			}
+			if (FCrc::MemCrc32(Bytes.GetData(), Bytes.Num()) != Event.Snapshot.Crc)
+			{
+				OutError = FString::Printf(TEXT("snapshot %s does not match the recording (CRC mismatch)"), *SnapshotPath);
+				return false;
+			}
+
+			FlightNavRecording::FGridSnapshot Snapshot;
+			if (!Snapshot.LoadFromBytes(Bytes))
+			{
+				OutError = FString::Printf(TEXT("snapshot %s is corrupt"), *SnapshotPath);
+				return false;
+			}
+
+			FlightNavReplayer::FStream& Stream = Streams.FindOrAdd(Event.Header.StreamId);
+			Stream.NodeSize = Event.Snapshot.NodeSize;
+			Snapshot.ToGrid(Stream.Grid);
+			// 与烘焙时一样在禁飞盒生效之前构建地标
+			Stream.Landmarks.Build(Stream.Grid, Stream.NodeSize, Event.Snapshot.NumLandmarks);
+			break;
+		}
+
+		case FlightNavRecording::EEventType::CellsChanged:
+		{
+			FlightNavReplayer::FStream* Stream = Streams.Find(Event.Header.StreamId);
+			if (!Stream)
+			{
+				break;
+			}
+			for (const FIntVector& Cell : Event.CellsChanged.Cells)
+			{
+				if (FAStarNode* Node = Stream->Grid.Find(FlightNavNeighborKernel::ToCenter(Cell, Stream->NodeSize)))
+				{
+					Node->bIsWalkable = Event.CellsChanged.bIsWalkable;
+				}
+			}
+			break;
+		}
+
+		case FlightNavRecording::EEventType::PathQuery:
+		{
+			const FlightNavRecording::FPathQueryEvent& Query = Event.Query;
+
+			FFlightNavReplayQueryResult& Result = OutResults.AddDefaulted_GetRef();
+			Result.QueryIndex = OutResults.Num() - 1;
+			Result.StreamId = Event.Header.StreamId;
+			Result.RecordedTimeSeconds = Event.Header.TimeSeconds;
+			Result.Start = Query.Start;
+			Result.Goal = Query.Goal;
+			Result.RecordedPathPoints = Query.PathPoints;
+			Result.RecordedPathHash = Query.PathHash;
+			Result.RecordedNodesExpanded = Query.NodesExpanded;
+			Result.RecordedMs = Query.WallTimeMs;
+
+			const FlightNavReplayer::FStream* Stream = Streams.Find(Event.Header.StreamId);
+			if (!Stream)
+			{
+				break;
+			}
+
+			Result.bReplayed = true;
+			Result.ReplayMs = TNumericLimits<float>::Max();
+			for (int32 Iteration = 0; Iteration < Repeat; ++Iteration)
+			{
+				FFlightNavQueryStats Stats;
+				const TArray<FVector> Path = UFlightNavigationBFL::FindPathWithStats(Query.Start, Query.Goal, Stream->Grid, Stream->NodeSize,
+					Stats, Stream->Landmarks.IsValid() ? &Stream->Landmarks : nullptr);
+				Result.ReplayPathPoints = Path.Num();
+				Result.ReplayPathHash = FlightNavRecording::HashPath(Path);
+				Result.ReplayNodesExpanded = Stats.NodesExpanded;
+				Result.ReplayMs = FMath::Min(Result.ReplayMs, Stats.WallTimeMs);
+			}
+			break;
+		}
+		}
+	}
+	return true;
+}
+
+void FFlightNavReplayer::LogSummary(const TArray<FFlightNavReplayQueryResult>& Results)
+{
+	TArray<float> ReplayMs;
+	TArray<const FFlightNavReplayQueryResult*> Searched;
+	double TotalRecordedMs = 0.0;
+	double TotalReplayMs = 0.0;
+	int64 TotalRecordedNodes = 0;
+	int64 TotalReplayNodes = 0;
+	int32 NumMismatches = 0;
+
+	// 没有快照的查询没有重放数据，不计入耗时与对比
+	for (const FFlightNavReplayQueryResult& Result : Results)
+	{
+		if (!Result.bReplayed)
+		{
+			continue;
+		}
+		Searched.Add(&Result);
+		ReplayMs.Add(Result.ReplayMs);
+		TotalRecordedMs += Result.RecordedMs;
+		TotalReplayMs += Result.ReplayMs;
+		TotalRecordedNodes += Result.RecordedNodesExpanded;
+		TotalReplayNodes += Result.ReplayNodesExpanded;
+		NumMismatches += Result.IsMismatch() ? 1 : 0;
+	}
+	ReplayMs.Sort();
+
+	UE_LOG(LogFlightNav, Display, TEXT("Replay: %d queries (%d searched, %d not replayed without a grid snapshot, %d path mismatches)"),
+		Results.Num(), Searched.Num(), Results.Num() - Searched.Num(), NumMismatches);
+	UE_LOG(LogFlightNav, Display, TEXT("Replay: total recorded %.3f ms, replayed %.3f ms; nodes expanded recorded %lld, replayed %lld"),
+		TotalRecordedMs, TotalReplayMs, TotalRecordedNodes, TotalReplayNodes);
+	UE_LOG(LogFlightNav, Display, TEXT("Replay: p50=%.3fms p95=%.3fms p99=%.3fms max=%.3fms"),
+		FlightNavReplayer::Percentile(ReplayMs, 0.50f), FlightNavReplayer::Percentile(ReplayMs, 0.95f),
+		FlightNavReplayer::Percentile(ReplayMs, 0.99f), ReplayMs.Num() > 0 ? ReplayMs.Last() : 0.0f);
+
+	Searched.Sort([](const FFlightNavReplayQueryResult& A, const FFlightNavReplayQueryResult& B)
+	{
+		return A.ReplayMs > B.ReplayMs;
+	});
+	for (int32 Index = 0; Index < FMath::Min(Searched.Num(), 5); ++Index)
+	{
+		const FFlightNavReplayQueryResult& Result = *Searched[Index];
+		UE_LOG(LogFlightNav, Display, TEXT("Replay slowest #%d: query %d at %.2fs, %s -> %s, replayed %.3f ms (recorded %.3f ms), nodes %d (recorded %d)%s"),
+			Index + 1, Result.QueryIndex, Result.RecordedTimeSeconds, *Result.Start.ToString(), *Result.Goal.ToString(),
+			Result.ReplayMs, Result.RecordedMs, Result.ReplayNodesExpanded, Result.RecordedNodesExpanded,
+			Result.IsMismatch() ? TEXT(" [path mismatch]") : TEXT(""));
+	}
+}
+
+bool FFlightNavReplayer::WriteCsv(const TArray<FFlightNavReplayQueryResult>& Results, const FString& CsvPath)
+{
+	FString Csv = TEXT("Query,Stream,TimeSeconds,StartX,StartY,StartZ,GoalX,GoalY,GoalZ,RecordedMs,ReplayMs,RecordedNodes,ReplayNodes,RecordedPathPoints,ReplayPathPoints,Replayed,PathMismatch\n");
+	for (const FFlightNavReplayQueryResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%d,%u,%.4f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.4f,%.4f,%d,%d,%d,%d,%d,%d\n"),
+			Result.QueryIndex, Result.StreamId, Result.RecordedTimeSeconds,
+			Result.Start.X, Result.Start.Y, Result.Start.Z, Result.Goal.X, Result.Goal.Y, Result.Goal.Z,
+			Result.RecordedMs, Result.ReplayMs,
+			Result.RecordedNodesExpanded, Result.ReplayNodesExpanded, Result.RecordedPathPoints, Result.ReplayPathPoints,
+			Result.bReplayed ? 1 : 0, Result.IsMismatch() ? 1 : 0);
+	}
+	return FFileHelper::SaveStringToFile(Csv, *CsvPath);
+}
+
+/*-----------控制台命令-----------------*/
+static void RunReplayCommand(const TArray<FString>& Args)
+{
+	if (Args.Num() == 0)
+	{
+		UE_LOG(LogFlightNav, Display, TEXT("Usage: FlightNav.Replay <Recording.fnrec> [Repeat] [Output.csv]"));
+		return;
+	}
+
+	FString Error;
+	FFlightNavReplayer Replayer;
+	TArray<FFlightNavReplayQueryResult> Results;
+	if (!Replayer.Load(Args[0], Error) ||
+		!Replayer.Run(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1, Results, Error))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Replay failed: %s"), *Error);
+		return;
+	}
+
+	FFlightNavReplayer::LogSummary(Results);
+	if (Args.Num() > 2 && !FFlightNavReplayer::WriteCsv(Results, Args[2]))
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Replay: cannot write %s"), *Args[2]);
+	}
+}
+
+static FAutoConsoleCommand GFlightNavReplayCommand(
+	TEXT("FlightNav.Replay"),
+	TEXT("离线重放录制文件并统计每次查询的耗时。参数：录制文件 [重复次数] [CSV 输出路径]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunReplayCommand));
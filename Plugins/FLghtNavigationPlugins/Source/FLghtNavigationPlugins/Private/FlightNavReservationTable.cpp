@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavReservationTable.h"
+
+uint32 FFlightNavReservationTable::GetOwner(const FIntVector& Cell, int32 TimeSlot) const
+{
+	const FFlightNavSpaceTimeKey Key(Cell, TimeSlot);
+	const FShard& Shard = GetShard(Key);
+
+	FReadScopeLock ReadLock(Shard.Lock);
+	const uint32* Owner = Shard.Entries.Find(Key);
+	return Owner ? *Owner : NoAgent;
+}
+
+bool FFlightNavReservationTable::TryReserve(const FIntVector& Cell, int32 TimeSlot, uint32 AgentId)
+{
+	const FFlightNavSpaceTimeKey Key(Cell, TimeSlot);
+	FShard& Shard = GetShard(Key);
+
+	FWriteScopeLock WriteLock(Shard.Lock);
+	uint32& Owner = Shard.Entries.FindOrAdd(Key, AgentId);
+	return Owner == AgentId;
+}
+
+void FFlightNavReservationTable::Release(TConstArrayView<FFlightNavSpaceTimeKey> Keys, uint32 AgentId)
+{
+	for (const FFlightNavSpaceTimeKey& Key : Keys)
+	{
+		FShard& Shard = GetShard(Key);
+
+		FWriteScopeLock WriteLock(Shard.Lock);
+		const uint32* Owner = Shard.Entries.Find(Key);
+		if (Owner && *Owner == AgentId)
+		{
+			Shard.Entries.Remove(Key);
+		}
+	}
+}
+
+void FFlightNavReservationTable::PruneBefore(int32 TimeSlot)
+{
+	for (FShard& Shard : Shards)
+	{
+		FWriteScopeLock WriteLock(Shard.Lock);
+		for (auto It = Shard.Entries.CreateIterator(); It; ++It)
+		{
+			if (It.Key().TimeSlot < TimeSlot)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+int32 FFlightNavReservationTable::Num() const
+{
+	int32 Count = 0;
+	for (const FShard& Shard : Shards)
+	{
+		FReadScopeLock ReadLock(Shard.Lock);
+		Count += Shard.Entries.Num();
+	}
+	return Count;
+}
@@ -0,0 +1,221 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY(LogFlightNav);
+
+DEFINE_STAT(STAT_FlightNav_Bake);
+DEFINE_STAT(STAT_FlightNav_BuildLandmarks);
+DEFINE_STAT(STAT_FlightNav_UpdateBanBox);
+DEFINE_STAT(STAT_FlightNav_FindPath);
+DEFINE_STAT(STAT_FlightNav_Raycast);
+DEFINE_STAT(STAT_FlightNav_Queries);
+DEFINE_STAT(STAT_FlightNav_NodesExpanded);
+DEFINE_STAT(STAT_FlightNav_HeapOperations);
+
+namespace FlightNavStats
+{
+	// 直方图各桶上界（毫秒），超过最后一个上界的样本落入溢出桶
+	static const float BucketUpperBoundsMs[] = { 0.1f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 33.0f, 66.0f };
+
+	static const TCHAR* GetMetricName(EFlightNavMetric Metric)
+	{
+		switch (Metric)
+		{
+		case EFlightNavMetric::FindPath:     return TEXT("FindPath");
+		case EFlightNavMetric::Bake:         return TEXT("Bake");
+		case EFlightNavMetric::BanBoxUpdate: return TEXT("BanBoxUpdate");
+		default:                             return TEXT("Unknown");
+		}
+	}
+
+	// 本线程上 FScopedSuppress 的嵌套层数
+	static thread_local int32 SuppressDepth = 0;
+
+	// 已排序样本的分位数
+	static float Percentile(const TArray<float>& SortedSamples, float Fraction)
+	{
+		if (SortedSamples.Num() == 0)
+		{
+			return 0.0f;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+}
+
+FFlightNavMetrics& FFlightNavMetrics::Get()
+{
+	static FFlightNavMetrics Instance;
+	return Instance;
+}
+
+FFlightNavMetrics::FScopedSuppress::FScopedSuppress()
+{
+	++FlightNavStats::SuppressDepth;
+}
+
+FFlightNavMetrics::FScopedSuppress::~FScopedSuppress()
+{
+	--FlightNavStats::SuppressDepth;
+}
+
+void FFlightNavMetrics::RecordLatency(EFlightNavMetric Metric, double Milliseconds)
+{
+	const int32 MetricIndex = static_cast<int32>(Metric);
+	if (MetricIndex < 0 || MetricIndex >= static_cast<int32>(EFlightNavMetric::Count) || FlightNavStats::SuppressDepth > 0)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&MetricsCriticalSection);
+	FRollingWindow& Window = Windows[MetricIndex];
+	if (Window.Samples.Num() < WindowSize)
+	{
+		Window.Samples.Add(static_cast<float>(Milliseconds));
+	}
+	else
+	{
+		Window.Samples[Window.NextIndex] = static_cast<float>(Milliseconds);
+	}
+	Window.NextIndex = (Window.NextIndex + 1) % WindowSize;
+	++Window.TotalCount;
+}
+
+void FFlightNavMetrics::RecordQuery(const FFlightNavQueryStats& Stats)
+{
+	if (FlightNavStats::SuppressDepth > 0)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_FlightNav_Queries);
+	INC_DWORD_STAT_BY(STAT_FlightNav_NodesExpanded, Stats.NodesExpanded);
+	INC_DWORD_STAT_BY(STAT_FlightNav_HeapOperations, Stats.HeapOperations);
+
+	FScopeLock Lock(&MetricsCriticalSection);
+	TotalNodesExpanded += Stats.NodesExpanded;
+	TotalHeapOperations += Stats.HeapOperations;
+}
+
+FFlightNavLatencySummary FFlightNavMetrics::GetSummary(EFlightNavMetric Metric) const
+{
+	FFlightNavLatencySummary Summary;
+	Summary.BucketUpperBoundsMs.Append(FlightNavStats::BucketUpperBoundsMs, UE_ARRAY_COUNT(FlightNavStats::BucketUpperBoundsMs));
+	Summary.HistogramBuckets.SetNumZeroed(Summary.BucketUpperBoundsMs.Num() + 1);
+
+	const int32 MetricIndex = static_cast<int32>(Metric);
+	if (MetricIndex < 0 || MetricIndex >= static_cast<int32>(EFlightNavMetric::Count))
+	{
+		return Summary;
+	}
+
+	// 拷贝出样本后再排序，避免长时间持锁
+	TArray<float> Samples;
+	{
+		FScopeLock Lock(&MetricsCriticalSection);
+		Samples = Windows[MetricIndex].Samples;
+		Summary.TotalCount = Windows[MetricIndex].TotalCount;
+	}
+
+	Summary.SampleCount = Samples.Num();
+	if (Samples.Num() == 0)
+	{
+		return Summary;
+	}
+
+	double Sum = 0.0;
+	for (const float Sample : Samples)
+	{
+		Sum += Sample;
+
+		int32 Bucket = 0;
+		while (Bucket < Summary.BucketUpperBoundsMs.Num() && Sample > Summary.BucketUpperBoundsMs[Bucket])
+		{
+			++Bucket;
+		}
+		++Summary.HistogramBuckets[Bucket];
+	}
+
+	Samples.Sort();
+	Summary.MeanMs = static_cast<float>(Sum / Samples.Num());
+	Summary.P50Ms = FlightNavStats::Percentile(Samples, 0.50f);
+	Summary.P95Ms = FlightNavStats::Percentile(Samples, 0.95f);
+	Summary.P99Ms = FlightNavStats::Percentile(Samples, 0.99f);
+	Summary.MaxMs = Samples.Last();
+	return Summary;
+}
+
+void FFlightNavMetrics::Reset()
+{
+	FScopeLock Lock(&MetricsCriticalSection);
+	for (FRollingWindow& Window : Windows)
+	{
+		Window = FRollingWindow();
+	}
+	TotalNodesExpanded = 0;
+	TotalHeapOperations = 0;
+}
+
+void FFlightNavMetrics::DumpToLog() const
+{
+	for (int32 MetricIndex = 0; MetricIndex < static_cast<int32>(EFlightNavMetric::Count); ++MetricIndex)
+	{
+		const EFlightNavMetric Metric = static_cast<EFlightNavMetric>(MetricIndex);
+		const FFlightNavLatencySummary Summary = GetSummary(Metric);
+
+		UE_LOG(LogFlightNav, Display, TEXT("%-12s total=%lld window=%d mean=%.3fms p50=%.3fms p95=%.3fms p99=%.3fms max=%.3fms"),
+			FlightNavStats::GetMetricName(Metric), Summary.TotalCount, Summary.SampleCount,
+			Summary.MeanMs, Summary.P50Ms, Summary.P95Ms, Summary.P99Ms, Summary.MaxMs);
+
+		FString Histogram;
+		for (int32 Bucket = 0; Bucket < Summary.HistogramBuckets.Num(); ++Bucket)
+		{
+			const FString Label = Bucket < Summary.BucketUpperBoundsMs.Num()
+				? FString::Printf(TEXT("<=%g"), Summary.BucketUpperBoundsMs[Bucket])
+				: TEXT(">");
+			Histogram += FString::Printf(TEXT(" [%s:%d]"), *Label, Summary.HistogramBuckets[Bucket]);
+		}
+		UE_LOG(LogFlightNav, Display, TEXT("%-12s histogram(ms):%s"), FlightNavStats::GetMetricName(Metric), *Histogram);
+	}
+
+	FScopeLock Lock(&MetricsCriticalSection);
+	UE_LOG(LogFlightNav, Display, TEXT("Queries: nodes expanded=%lld heap ops=%lld"),
+		TotalNodesExpanded, TotalHeapOperations);
+}
+
+FFlightNavScopedLatency::FFlightNavScopedLatency(EFlightNavMetric InMetric)
+	: Metric(InMetric)
+	, StartSeconds(FPlatformTime::Seconds())
+{
+}
+
+FFlightNavScopedLatency::~FFlightNavScopedLatency()
+{
+	FFlightNavMetrics::Get().RecordLatency(Metric, GetElapsedMs());
+}
+
+double FFlightNavScopedLatency::GetElapsedMs() const
+{
+	return (FPlatformTime::Seconds() - StartSeconds) * 1000.0;
+}
+
+/*-----------控制台命令-----------------*/
+static FAutoConsoleCommand GFlightNavStatsDumpCommand(
+	TEXT("FlightNav.Stats.Dump"),
+	TEXT("输出飞行导航的耗时直方图与寻路计数"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FFlightNavMetrics::Get().DumpToLog();
+	}));
+
+static FAutoConsoleCommand GFlightNavStatsResetCommand(
+	TEXT("FlightNav.Stats.Reset"),
+	TEXT("清空飞行导航的耗时统计"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FFlightNavMetrics::Get().Reset();
+	}));
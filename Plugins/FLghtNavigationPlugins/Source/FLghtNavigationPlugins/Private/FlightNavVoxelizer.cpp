@@ -0,0 +1,544 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavVoxelizer.h"
+#include "FlightNavStats.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace FlightNavVoxelizer
+{
+	// 格子半边长的放大量（相对体素大小），抵消浮点误差，保证测试保守
+	static constexpr double CellInflation = 1.0e-3;
+
+	// 与 IsLocationWalkable 使用的通道一致
+	static constexpr ECollisionChannel BlockingChannel = ECC_Visibility;
+
+	static void AddBoxPlanes(const FVector& HalfExtent, const FMatrix& Matrix, TArray<FPlane>& OutPlanes)
+	{
+		OutPlanes.Add(FPlane(FVector(1.0, 0.0, 0.0), HalfExtent.X).TransformBy(Matrix));
+		OutPlanes.Add(FPlane(FVector(-1.0, 0.0, 0.0), HalfExtent.X).TransformBy(Matrix));
+		OutPlanes.Add(FPlane(FVector(0.0, 1.0, 0.0), HalfExtent.Y).TransformBy(Matrix));
+		OutPlanes.Add(FPlane(FVector(0.0, -1.0, 0.0), HalfExtent.Y).TransformBy(Matrix));
+		OutPlanes.Add(FPlane(FVector(0.0, 0.0, 1.0), HalfExtent.Z).TransformBy(Matrix));
+		OutPlanes.Add(FPlane(FVector(0.0, 0.0, -1.0), HalfExtent.Z).TransformBy(Matrix));
+	}
+
+	// 三角形与轴对齐盒体的分离轴测试（Akenine-Möller），13 条轴
+	static bool TriangleOverlapsBox(const FVector& A, const FVector& B, const FVector& C, const FVector& BoxCenter, const FVector& HalfExtent)
+	{
+		const FVector V0 = A - BoxCenter;
+		const FVector V1 = B - BoxCenter;
+		const FVector V2 = C - BoxCenter;
+
+		// 盒体的三个面法线
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (FMath::Min3(V0[Axis], V1[Axis], V2[Axis]) > HalfExtent[Axis] ||
+				FMath::Max3(V0[Axis], V1[Axis], V2[Axis]) < -HalfExtent[Axis])
+			{
+				return false;
+			}
+		}
+
+		// 三角形所在平面
+		const FVector E0 = V1 - V0;
+		const FVector E1 = V2 - V1;
+		const FVector E2 = V0 - V2;
+		const FVector Normal = FVector::CrossProduct(E0, E1);
+		const double PlaneRadius = HalfExtent.X * FMath::Abs(Normal.X) + HalfExtent.Y * FMath::Abs(Normal.Y) + HalfExtent.Z * FMath::Abs(Normal.Z);
+		if (FMath::Abs(FVector::DotProduct(Normal, V0)) > PlaneRadius)
+		{
+			return false;
+		}
+
+		// 盒体轴与三角形边的叉积
+		const FVector Edges[3] = { E0, E1, E2 };
+		for (const FVector& Edge : Edges)
+		{
+			for (int32 BoxAxis = 0; BoxAxis < 3; ++BoxAxis)
+			{
+				FVector Unit = FVector::ZeroVector;
+				Unit[BoxAxis] = 1.0;
+				const FVector Axis = FVector::CrossProduct(Unit, Edge);
+
+				const double P0 = FVector::DotProduct(V0, Axis);
+				const double P1 = FVector::DotProduct(V1, Axis);
+				const double P2 = FVector::DotProduct(V2, Axis);
+				const double Radius = HalfExtent.X * FMath::Abs(Axis.X) + HalfExtent.Y * FMath::Abs(Axis.Y) + HalfExtent.Z * FMath::Abs(Axis.Z);
+				if (FMath::Min3(P0, P1, P2) > Radius || FMath::Max3(P0, P1, P2) < -Radius)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// 线段到轴对齐盒体的最小距离平方
+	// 线段与盒体各面所在平面的交点把参数区间分成若干段，每段内各轴在盒内/盒外的状态固定，
+	// 距离平方是 t 的二次函数，取其在该段内的最小值
+	static double SegmentBoxDistSquared(const FVector& A, const FVector& B, const FVector& BoxMin, const FVector& BoxMax)
+	{
+		const FVector Dir = B - A;
+
+		double Breaks[8];
+		int32 NumBreaks = 0;
+		Breaks[NumBreaks++] = 0.0;
+		Breaks[NumBreaks++] = 1.0;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (FMath::IsNearlyZero(Dir[Axis]))
+			{
+				continue;
+			}
+			for (const double Bound : { BoxMin[Axis], BoxMax[Axis] })
+			{
+				const double T = (Bound - A[Axis]) / Dir[Axis];
+				if (T > 0.0 && T < 1.0)
+				{
+					Breaks[NumBreaks++] = T;
+				}
+			}
+		}
+		Algo::Sort(MakeArrayView(Breaks, NumBreaks));
+
+		double Best = TNumericLimits<double>::Max();
+		for (int32 Index = 0; Index + 1 < NumBreaks; ++Index)
+		{
+			const double T0 = Breaks[Index];
+			const double T1 = Breaks[Index + 1];
+			const FVector Mid = A + Dir * ((T0 + T1) * 0.5);
+
+			// f(t) = QuadA * t^2 + QuadB * t + QuadC，只累加在盒外的轴
+			double QuadA = 0.0;
+			double QuadB = 0.0;
+			double QuadC = 0.0;
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				double Clamp;
+				if (Mid[Axis] < BoxMin[Axis])
+				{
+					Clamp = BoxMin[Axis];
+				}
+				else if (Mid[Axis] > BoxMax[Axis])
+				{
+					Clamp = BoxMax[Axis];
+				}
+				else
+				{
+					continue;
+				}
+				const double Offset = A[Axis] - Clamp;
+				QuadA += Dir[Axis] * Dir[Axis];
+				QuadB += 2.0 * Dir[Axis] * Offset;
+				QuadC += Offset * Offset;
+			}
+
+			const double T = QuadA > 0.0 ? FMath::Clamp(-QuadB / (2.0 * QuadA), T0, T1) : T0;
+			Best = FMath::Min(Best, FMath::Max((QuadA * T + QuadB) * T + QuadC, 0.0));
+		}
+		return Best;
+	}
+}
+
+FFlightNavVoxelizer::FFlightNavVoxelizer(const FVector& InMinBounds, const FVector& InMaxBounds, float InVoxelSize)
+	: MinBounds(InMinBounds)
+	, VoxelSize(InVoxelSize)
+	, Dimensions(FIntVector::ZeroValue)
+	, GridBox(InMinBounds, InMaxBounds)
+{
+	if (VoxelSize > 0.0f)
+	{
+		const FVector Extent = InMaxBounds - InMinBounds;
+		const FVector Cells(
+			FMath::Max(FMath::RoundToDouble(Extent.X / VoxelSize), 0.0),
+			FMath::Max(FMath::RoundToDouble(Extent.Y / VoxelSize), 0.0),
+			FMath::Max(FMath::RoundToDouble(Extent.Z / VoxelSize), 0.0));
+		// 单个方向就超出 int32 时三个方向都记为上限，Rasterize 会拒绝这个网格
+		Dimensions = Cells.GetMax() > static_cast<double>(MaxCells)
+			? FIntVector(MAX_int32)
+			: FIntVector(static_cast<int32>(Cells.X), static_cast<int32>(Cells.Y), static_cast<int32>(Cells.Z));
+	}
+}
+
+void FFlightNavVoxelizer::GatherWorld(const UWorld* World)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_VoxelizerGather);
+
+	if (!World)
+	{
+		return;
+	}
+
+	for (const ULevel* Level : World->GetLevels())
+	{
+		if (!Level)
+		{
+			continue;
+		}
+		for (AActor* Actor : Level->Actors)
+		{
+			if (!IsValid(Actor))
+			{
+				continue;
+			}
+			Actor->ForEachComponent<UPrimitiveComponent>(false, [this](UPrimitiveComponent* Component)
+			{
+				AddComponent(Component);
+			});
+		}
+	}
+}
+
+void FFlightNavVoxelizer::AddComponent(UPrimitiveComponent* Component)
+{
+	// 与物理重叠查询的过滤条件一致：开启查询碰撞且阻挡检测通道
+	if (!IsValid(Component) || !Component->IsQueryCollisionEnabled() ||
+		Component->GetCollisionResponseToChannel(FlightNavVoxelizer::BlockingChannel) != ECR_Block)
+	{
+		return;
+	}
+
+	// commandlet 中组件可能未注册，需要先算出世界变换与包围盒
+	Component->ConditionalUpdateComponentToWorld();
+	if (!Component->Bounds.GetBox().Intersect(GridBox))
+	{
+		return;
+	}
+
+	const UBodySetup* BodySetup = Component->GetBodySetup();
+	if (!BodySetup)
+	{
+		return;
+	}
+
+	UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Component);
+	UStaticMesh* StaticMesh = StaticMeshComponent ? StaticMeshComponent->GetStaticMesh() : nullptr;
+
+	if (const UInstancedStaticMeshComponent* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component))
+	{
+		const FBox MeshBounds = StaticMesh ? StaticMesh->GetBounds().GetBox() : FBox(ForceInit);
+		for (int32 InstanceIndex = 0; InstanceIndex < InstancedComponent->GetInstanceCount(); ++InstanceIndex)
+		{
+			FTransform InstanceTransform;
+			if (InstancedComponent->GetInstanceTransform(InstanceIndex, InstanceTransform, true))
+			{
+				const FBox InstanceBounds = MeshBounds.TransformBy(InstanceTransform);
+				if (InstanceBounds.Intersect(GridBox))
+				{
+					AddBodySetup(BodySetup, StaticMesh, InstanceTransform, InstanceBounds);
+				}
+			}
+		}
+		return;
+	}
+
+	AddBodySetup(BodySetup, StaticMesh, Component->GetComponentTransform(), Component->Bounds.GetBox());
+}
+
+void FFlightNavVoxelizer::AddBodySetup(const UBodySetup* BodySetup, UStaticMesh* StaticMesh, const FTransform& Transform, const FBox& FallbackBounds)
+{
+	if (BodySetup->GetCollisionTraceFlag() == CTF_UseComplexAsSimple)
+	{
+		if (!StaticMesh || !AddTriangleMesh(StaticMesh, Transform))
+		{
+			// 读不到三角形（如打包后未开启 CPU 访问）时，用包围盒保守地整块标记
+			UE_LOG(LogFlightNav, Warning, TEXT("Voxelizer: no triangle data for %s, blocking its bounds instead."),
+				*GetNameSafe(StaticMesh ? static_cast<const UObject*>(StaticMesh) : BodySetup));
+			TArray<FPlane> Planes;
+			FlightNavVoxelizer::AddBoxPlanes(FallbackBounds.GetExtent(), FTranslationMatrix(FallbackBounds.GetCenter()), Planes);
+			AddConvex(MoveTemp(Planes), FallbackBounds);
+		}
+		return;
+	}
+
+	const FKAggregateGeom& Geometry = BodySetup->AggGeom;
+	const double MaxScale = Transform.GetScale3D().GetAbsMax();
+
+	for (const FKBoxElem& Box : Geometry.BoxElems)
+	{
+		const FTransform ElementTransform = Box.GetTransform() * Transform;
+		const FVector HalfExtent(Box.X * 0.5f, Box.Y * 0.5f, Box.Z * 0.5f);
+		TArray<FPlane> Planes;
+		FlightNavVoxelizer::AddBoxPlanes(HalfExtent, ElementTransform.ToMatrixWithScale(), Planes);
+		AddConvex(MoveTemp(Planes), FBox(-HalfExtent, HalfExtent).TransformBy(ElementTransform));
+	}
+
+	for (const FKConvexElem& Convex : Geometry.ConvexElems)
+	{
+		const FTransform ElementTransform = Convex.GetTransform() * Transform;
+		const FMatrix Matrix = ElementTransform.ToMatrixWithScale();
+		const FBox Bounds = Convex.ElemBox.TransformBy(ElementTransform);
+
+		TArray<FPlane> LocalPlanes;
+		Convex.GetPlanes(LocalPlanes);
+
+		TArray<FPlane> Planes;
+		if (LocalPlanes.Num() > 0)
+		{
+			Planes.Reserve(LocalPlanes.Num());
+			for (const FPlane& Plane : LocalPlanes)
+			{
+				Planes.Add(Plane.TransformBy(Matrix));
+			}
+		}
+		else
+		{
+			// 没有烘焙好的凸包数据时退化为包围盒
+			FlightNavVoxelizer::AddBoxPlanes(Bounds.GetExtent(), FTranslationMatrix(Bounds.GetCenter()), Planes);
+		}
+		AddConvex(MoveTemp(Planes), Bounds);
+	}
+
+	// 非等比缩放时球体与胶囊体按最大缩放取半径，结果偏保守
+	for (const FKSphereElem& Sphere : Geometry.SphereElems)
+	{
+		FSolid& Solid = Solids.AddDefaulted_GetRef();
+		Solid.Type = ESolidType::Sphere;
+		Solid.A = Transform.TransformPosition(Sphere.Center);
+		Solid.Radius = Sphere.Radius * MaxScale;
+		Solid.Bounds = FBox(Solid.A - FVector(Solid.Radius), Solid.A + FVector(Solid.Radius));
+	}
+
+	for (const FKSphylElem& Sphyl : Geometry.SphylElems)
+	{
+		const FTransform ElementTransform = Sphyl.GetTransform() * Transform;
+		const FVector HalfAxis(0.0, 0.0, Sphyl.Length * 0.5f);
+
+		FSolid& Solid = Solids.AddDefaulted_GetRef();
+		Solid.Type = ESolidType::Capsule;
+		Solid.A = ElementTransform.TransformPosition(HalfAxis);
+		Solid.B = ElementTransform.TransformPosition(-HalfAxis);
+		Solid.Radius = Sphyl.Radius * MaxScale;
+		Solid.Bounds = FBox(Solid.A.ComponentMin(Solid.B) - FVector(Solid.Radius), Solid.A.ComponentMax(Solid.B) + FVector(Solid.Radius));
+	}
+
+	// 锥形胶囊体按两端较大的半径处理
+	for (const FKTaperedCapsuleElem& Tapered : Geometry.TaperedCapsuleElems)
+	{
+		const FTransform ElementTransform = Tapered.GetTransform() * Transform;
+		const FVector HalfAxis(0.0, 0.0, Tapered.Length * 0.5f);
+
+		FSolid& Solid = Solids.AddDefaulted_GetRef();
+		Solid.Type = ESolidType::Capsule;
+		Solid.A = ElementTransform.TransformPosition(HalfAxis);
+		Solid.B = ElementTransform.TransformPosition(-HalfAxis);
+		Solid.Radius = FMath::Max(Tapered.Radius0, Tapered.Radius1) * MaxScale;
+		Solid.Bounds = FBox(Solid.A.ComponentMin(Solid.B) - FVector(Solid.Radius), Solid.A.ComponentMax(Solid.B) + FVector(Solid.Radius));
+	}
+}
+
+bool FFlightNavVoxelizer::AddTriangleMesh(UStaticMesh* StaticMesh, const FTransform& Transform)
+{
+	FTriMeshCollisionData TriangleData;
+	if (!StaticMesh->ContainsPhysicsTriMeshData(true) || !StaticMesh->GetPhysicsTriMeshData(&TriangleData, true))
+	{
+		return false;
+	}
+
+	TArray<FVector> WorldVertices;
+	WorldVertices.Reserve(TriangleData.Vertices.Num());
+	for (const FVector3f& Vertex : TriangleData.Vertices)
+	{
+		WorldVertices.Add(Transform.TransformPosition(FVector(Vertex)));
+	}
+
+	Triangles.Reserve(Triangles.Num() + TriangleData.Indices.Num());
+	for (const FTriIndices& Indices : TriangleData.Indices)
+	{
+		FTriangle Triangle;
+		Triangle.V0 = WorldVertices[Indices.v0];
+		Triangle.V1 = WorldVertices[Indices.v1];
+		Triangle.V2 = WorldVertices[Indices.v2];
+		Triangle.Bounds = FBox(Triangle.V0.ComponentMin(Triangle.V1).ComponentMin(Triangle.V2),
+			Triangle.V0.ComponentMax(Triangle.V1).ComponentMax(Triangle.V2));
+		if (Triangle.Bounds.Intersect(GridBox))
+		{
+			Triangles.Add(Triangle);
+		}
+	}
+	return true;
+}
+
+void FFlightNavVoxelizer::AddConvex(TArray<FPlane>&& Planes, const FBox& Bounds)
+{
+	if (!Bounds.Intersect(GridBox))
+	{
+		return;
+	}
+
+	FSolid& Solid = Solids.AddDefaulted_GetRef();
+	Solid.Type = ESolidType::Convex;
+	Solid.Bounds = Bounds;
+	Solid.Planes = MoveTemp(Planes);
+}
+
+bool FFlightNavVoxelizer::GetCellRange(const FBox& Box, FIntVector& OutMin, FIntVector& OutMax) const
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		OutMin[Axis] = FMath::Max(FMath::FloorToInt((Box.Min[Axis] - MinBounds[Axis]) / VoxelSize), 0);
+		OutMax[Axis] = FMath::Min(FMath::FloorToInt((Box.Max[Axis] - MinBounds[Axis]) / VoxelSize), Dimensions[Axis] - 1);
+		if (OutMin[Axis] > OutMax[Axis])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FFlightNavVoxelizer::SolidOverlapsCell(const FSolid& Solid, const FVector& Center, const FVector& HalfExtent)
+{
+	switch (Solid.Type)
+	{
+	case ESolidType::Convex:
+		// 盒体在某个平面外侧即分离；只用凸包平面测试，凸包棱附近可能多标记，结果偏保守
+		for (const FPlane& Plane : Solid.Planes)
+		{
+			const double Reach = HalfExtent.X * FMath::Abs(Plane.X) + HalfExtent.Y * FMath::Abs(Plane.Y) + HalfExtent.Z * FMath::Abs(Plane.Z);
+			if (Plane.PlaneDot(Center) > Reach)
+			{
+				return false;
+			}
+		}
+		return true;
+
+	case ESolidType::Sphere:
+		return FBox(Center - HalfExtent, Center + HalfExtent).ComputeSquaredDistanceToPoint(Solid.A) <= FMath::Square(Solid.Radius);
+
+	case ESolidType::Capsule:
+		// 胶囊体即到轴线距离不超过半径的点集：轴线到格子的最小距离不超过半径即重叠
+		return FlightNavVoxelizer::SegmentBoxDistSquared(Solid.A, Solid.B, Center - HalfExtent, Center + HalfExtent) <= FMath::Square(Solid.Radius);
+
+	default:
+		return false;
+	}
+}
+
+bool FFlightNavVoxelizer::TriangleOverlapsCell(const FTriangle& Triangle, const FVector& Center, const FVector& HalfExtent)
+{
+	return FlightNavVoxelizer::TriangleOverlapsBox(Triangle.V0, Triangle.V1, Triangle.V2, Center, HalfExtent);
+}
+
+bool FFlightNavVoxelizer::Rasterize(TMap<FVector, FAStarNode>& OutGrid) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_VoxelizerRasterize);
+
+	OutGrid.Reset();
+	if (Dimensions.X <= 0 || Dimensions.Y <= 0 || Dimensions.Z <= 0)
+	{
+		return true;
+	}
+	// 先检查两个方向的乘积，三个 int32 直接相乘可能超出 int64
+	const int64 SliceCells = int64(Dimensions.X) * Dimensions.Y;
+	if (SliceCells > MaxCells || SliceCells * Dimensions.Z > MaxCells)
+	{
+		UE_LOG(LogFlightNav, Error, TEXT("Voxelizer: %d x %d x %d cells exceed the grid limit of %lld, increase NodeSize."),
+			Dimensions.X, Dimensions.Y, Dimensions.Z, MaxCells);
+		return false;
+	}
+	const int32 NumCells = static_cast<int32>(SliceCells * Dimensions.Z);
+
+	// 按 X 切片分桶，每个切片只处理与之相交的几何
+	TArray<TArray<int32>> SliceSolids;
+	TArray<TArray<int32>> SliceTriangles;
+	SliceSolids.SetNum(Dimensions.X);
+	SliceTriangles.SetNum(Dimensions.X);
+
+	FIntVector CellMin;
+	FIntVector CellMax;
+	for (int32 Index = 0; Index < Solids.Num(); ++Index)
+	{
+		if (GetCellRange(Solids[Index].Bounds, CellMin, CellMax))
+		{
+			for (int32 X = CellMin.X; X <= CellMax.X; ++X)
+			{
+				SliceSolids[X].Add(Index);
+			}
+		}
+	}
+	for (int32 Index = 0; Index < Triangles.Num(); ++Index)
+	{
+		if (GetCellRange(Triangles[Index].Bounds, CellMin, CellMax))
+		{
+			for (int32 X = CellMin.X; X <= CellMax.X; ++X)
+			{
+				SliceTriangles[X].Add(Index);
+			}
+		}
+	}
+
+	TArray<uint8> Occupied;
+	Occupied.SetNumZeroed(NumCells);
+
+	const FVector HalfExtent(VoxelSize * (0.5 + FlightNavVoxelizer::CellInflation));
+	const int64 SliceStride = int64(Dimensions.Y) * Dimensions.Z;
+
+	ParallelFor(Dimensions.X, [&](int32 X)
+	{
+		uint8* Slice = Occupied.GetData() + X * SliceStride;
+
+		auto RasterizeRange = [&](const FBox& Bounds, auto&& Overlaps)
+		{
+			FIntVector RangeMin;
+			FIntVector RangeMax;
+			if (!GetCellRange(Bounds, RangeMin, RangeMax))
+			{
+				return;
+			}
+			for (int32 Y = RangeMin.Y; Y <= RangeMax.Y; ++Y)
+			{
+				for (int32 Z = RangeMin.Z; Z <= RangeMax.Z; ++Z)
+				{
+					uint8& Cell = Slice[int64(Y) * Dimensions.Z + Z];
+					if (!Cell && Overlaps(MinBounds + (FVector(X, Y, Z) + 0.5) * VoxelSize))
+					{
+						Cell = 1;
+					}
+				}
+			}
+		};
+
+		for (const int32 SolidIndex : SliceSolids[X])
+		{
+			const FSolid& Solid = Solids[SolidIndex];
+			RasterizeRange(Solid.Bounds, [&Solid, &HalfExtent](const FVector& Center)
+			{
+				return SolidOverlapsCell(Solid, Center, HalfExtent);
+			});
+		}
+		for (const int32 TriangleIndex : SliceTriangles[X])
+		{
+			const FTriangle& Triangle = Triangles[TriangleIndex];
+			RasterizeRange(Triangle.Bounds, [&Triangle, &HalfExtent](const FVector& Center)
+			{
+				return TriangleOverlapsCell(Triangle, Center, HalfExtent);
+			});
+		}
+	});
+
+	// 按 X、Y、Z 顺序插入，与 GenerateVoxelGrid 的插入顺序一致
+	OutGrid.Reserve(NumCells);
+	int32 CellIndex = 0;
+	for (int32 X = 0; X < Dimensions.X; ++X)
+	{
+		for (int32 Y = 0; Y < Dimensions.Y; ++Y)
+		{
+			for (int32 Z = 0; Z < Dimensions.Z; ++Z)
+			{
+				const FVector VoxelCenter = MinBounds + (FVector(X, Y, Z) + 0.5) * VoxelSize;
+				OutGrid.Add(VoxelCenter, FAStarNode(VoxelCenter, VoxelSize, Occupied[CellIndex++] == 0));
+			}
+		}
+	}
+	return true;
+}
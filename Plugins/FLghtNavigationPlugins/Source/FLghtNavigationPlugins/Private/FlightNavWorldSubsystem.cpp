@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FlightNavWorldSubsystem.h"
+#include "Engine/World.h"
+
+int32 UFlightNavWorldSubsystem::GetCurrentTimeSlot() const
+{
+	const UWorld* World = GetWorld();
+	if (!World || SecondsPerTimeSlot <= 0.0f)
+	{
+		return 0;
+	}
+	return FMath::FloorToInt(World->GetTimeSeconds() / SecondsPerTimeSlot);
+}
+
+void UFlightNavWorldSubsystem::PruneExpiredReservations()
+{
+	const int32 CurrentTimeSlot = GetCurrentTimeSlot();
+	int32 LastPruned = LastPrunedTimeSlot.load();
+	if (CurrentTimeSlot - LastPruned < PruneIntervalSlots)
+	{
+		return;
+	}
+
+	// 只让一个调用者执行清理
+	if (LastPrunedTimeSlot.compare_exchange_strong(LastPruned, CurrentTimeSlot))
+	{
+		ReservationTable.PruneBefore(CurrentTimeSlot);
+	}
+}
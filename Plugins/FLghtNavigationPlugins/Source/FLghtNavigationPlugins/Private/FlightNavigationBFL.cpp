@@ -1,186 +1,247 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 #include "FlightNavigationBFL.h"
+#include "FlightNavNeighborKernel.h"
+#include "FlightNavVoxelizer.h"
 #include "Engine/World.h"
 #include "Chaos/ChaosEngineInterface.h"
-#include "DrawDebugHelpers.h"
 #include "Engine/OverlapResult.h"
 #include "CollisionShape.h"
 #include "Engine/CollisionProfile.h"
+#include "Misc/ScopeExit.h"
+#include "Algo/Reverse.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
+namespace FlightNavSearch
+{
+	// 一次搜索的目标集合，单目标寻路是只有一个元素的特例
+	struct FGoalSet
+	{
+		// 目标格子 -> 在调用方目标数组中的下标（同一格子只保留第一个）
+		TMap<FIntVector, int32> Cells;
+		// 目标格子中心的包围盒；点到包围盒的距离不大于到任一目标的距离，是 O(1) 的可采纳下界
+		FBox Bounds = FBox(ForceInit);
+		// 各地标到目标集合距离的最小值与最大值，见 FFlightNavLandmarks::GetLowerBoundToSet
+		const FFlightNavLandmarks* Landmarks = nullptr;
+		TArray<float> MinLandmarkDistances;
+		TArray<float> MaxLandmarkDistances;
+	};
+
+	// 网格中不可通行的目标不可达（与起点重合时除外），网格外的目标视为可通行；没有可用目标时返回 false
+	static bool BuildGoalSet(const FIntVector& StartCell, TConstArrayView<FVector> Goals, const TMap<FVector, FAStarNode>& GridNodes,
+		float NodeSize, const FFlightNavLandmarks* Landmarks, FGoalSet& OutGoalSet)
+	{
+		TArray<FVector> GoalCenters;
+		GoalCenters.Reserve(Goals.Num());
+		OutGoalSet.Cells.Reserve(Goals.Num());
+		for (int32 GoalIndex = 0; GoalIndex < Goals.Num(); ++GoalIndex)
+		{
+			const FVector GoalGridCenter = UFlightNavigationBFL::GetGridCenter(Goals[GoalIndex], NodeSize);
+			const FIntVector GoalCell = FlightNavNeighborKernel::ToCell(GoalGridCenter, NodeSize);
+			const FAStarNode* GoalNode = GridNodes.Find(GoalGridCenter);
+			if ((GoalNode && !GoalNode->bIsWalkable && GoalCell != StartCell) || OutGoalSet.Cells.Contains(GoalCell))
+			{
+				continue;
+			}
+			OutGoalSet.Cells.Add(GoalCell, GoalIndex);
+			OutGoalSet.Bounds += GoalGridCenter;
+			GoalCenters.Add(GoalGridCenter);
+		}
+
+		if (Landmarks && Landmarks->PrepareGoalSet(GoalCenters, OutGoalSet.MinLandmarkDistances, OutGoalSet.MaxLandmarkDistances))
+		{
+			OutGoalSet.Landmarks = Landmarks;
+		}
+		return OutGoalSet.Cells.Num() > 0;
+	}
+
+	/**
+	 * A* 主循环，FindPathWithStats 与 FindPathToNearestGoal 共用
+	 *
+	 * 不拷贝网格：每次查询的 g 值、父节点与关闭标记保存在以格子坐标为键的旁路表中。
+	 * 第一个出队的目标就是代价最小的目标，查询代价与目标数无关。
+	 */
+	static TArray<FVector> Search(const FVector& StartGridCenter, const FGoalSet& GoalSet, const TMap<FVector, FAStarNode>& GridNodes,
+		float NodeSize, int32& OutGoalIndex, FFlightNavQueryStats& OutStats)
+	{
+		const FIntVector StartCell = FlightNavNeighborKernel::ToCell(StartGridCenter, NodeSize);
+
+		// 只有一个目标时 h 直接用核函数批量算出的欧几里得距离（与到包围盒的距离相同）
+		const bool bSingleGoal = GoalSet.Cells.Num() == 1;
+		const FIntVector SingleGoalCell = GoalSet.Cells.CreateConstIterator()->Key;
+		auto IsGoalCell = [&GoalSet, bSingleGoal, &SingleGoalCell](const FIntVector& Cell)
+		{
+			return bSingleGoal ? Cell == SingleGoalCell : GoalSet.Cells.Contains(Cell);
+		};
+		auto BoundsDistance = [&GoalSet](const FVector& Center)
+		{
+			return FMath::Sqrt(static_cast<float>(GoalSet.Bounds.ComputeSquaredDistanceToPoint(Center)));
+		};
+		auto GoalHeuristic = [&GoalSet](const FVector& Center, float EuclideanH)
+		{
+			if (!GoalSet.Landmarks)
+			{
+				return EuclideanH;
+			}
+			return FMath::Max(EuclideanH, GoalSet.Landmarks->GetLowerBoundToSet(Center, GoalSet.MinLandmarkDistances, GoalSet.MaxLandmarkDistances));
+		};
+
+		struct FSearchNode
+		{
+			float G = TNumericLimits<float>::Max();
+			FIntVector Parent = FIntVector::ZeroValue;
+			bool bHasParent = false;
+			bool bClosed = false;
+		};
+
+		// 开放集是按 F 排序的二叉堆，g 变小时直接压入新条目，出队时跳过过期条目
+		struct FOpenEntry
+		{
+			FIntVector Cell;
+			float G;
+			float F;
+
+			bool operator<(const FOpenEntry& Other) const { return F < Other.F; }
+		};
+
+		TMap<FIntVector, FSearchNode> SearchNodes;
+		TArray<FOpenEntry> OpenSet;
+
+		SearchNodes.Add(StartCell).G = 0.0f;
+		OpenSet.HeapPush({ StartCell, 0.0f, GoalHeuristic(StartGridCenter, BoundsDistance(StartGridCenter)) });
+		++OutStats.HeapOperations;
+
+		while (!OpenSet.IsEmpty())
+		{
+			FOpenEntry Entry;
+			OpenSet.HeapPop(Entry, EAllowShrinking::No);
+			++OutStats.HeapOperations;
+
+			FSearchNode& CurrentNode = SearchNodes.FindChecked(Entry.Cell);
+			if (CurrentNode.bClosed || Entry.G != CurrentNode.G)
+			{
+				continue;
+			}
+			CurrentNode.bClosed = true;
+			++OutStats.NodesExpanded;
+
+			// 检查是否到达目标，沿父节点回溯
+			if (const int32* GoalIndex = GoalSet.Cells.Find(Entry.Cell))
+			{
+				OutGoalIndex = *GoalIndex;
+				TArray<FVector> Path;
+				FIntVector Cell = Entry.Cell;
+				while (true)
+				{
+					const FSearchNode& Node = SearchNodes.FindChecked(Cell);
+					if (!Node.bHasParent)
+					{
+						break;
+					}
+					Path.Add(FlightNavNeighborKernel::ToCenter(Cell, NodeSize));
+					Cell = Node.Parent;
+				}
+				Path.Add(StartGridCenter);
+				Algo::Reverse(Path);
+				return Path;
+			}
+
+			// 一次算出 26 个邻居的 g 与 h（向量化，单精度，整数格子偏移）；多目标时只用其中的 g
+			FFlightNavNeighborBatch Batch;
+			FlightNavNeighborKernel::Evaluate(Entry.Cell, bSingleGoal ? SingleGoalCell : Entry.Cell, Entry.G, NodeSize, Batch);
+
+			for (int32 NeighborIndex = 0; NeighborIndex < FFlightNavNeighborBatch::NumNeighbors; ++NeighborIndex)
+			{
+				const FIntVector NeighborCell = Entry.Cell + FlightNavNeighborKernel::GetOffset(NeighborIndex);
+				const FVector NeighborCenter = FlightNavNeighborKernel::ToCenter(NeighborCell, NodeSize);
+
+				// 跳过网格外（目标除外）与不可通行的节点
+				const FAStarNode* GridNode = GridNodes.Find(NeighborCenter);
+				if ((!GridNode || !GridNode->bIsWalkable) && !IsGoalCell(NeighborCell))
+				{
+					continue;
+				}
+
+				const float TentativeGScore = Batch.G[NeighborIndex];
+				FSearchNode& NeighborNode = SearchNodes.FindOrAdd(NeighborCell);
+				if (NeighborNode.bClosed || TentativeGScore >= NeighborNode.G)
+				{
+					continue;
+				}
+
+				// 发现更优路径
+				NeighborNode.G = TentativeGScore;
+				NeighborNode.Parent = Entry.Cell;
+				NeighborNode.bHasParent = true;
+				const float NeighborH = GoalHeuristic(NeighborCenter, bSingleGoal ? Batch.H[NeighborIndex] : BoundsDistance(NeighborCenter));
+				OpenSet.HeapPush({ NeighborCell, TentativeGScore, TentativeGScore + NeighborH });
+				++OutStats.HeapOperations;
+			}
+		}
+
+		return TArray<FVector>(); // 没找到路径
+	}
+}
 
 TArray<FVector> UFlightNavigationBFL::FindPath(const FVector& Start, const FVector& Goal,
 	const TMap<FVector, FAStarNode>& GridNodes, float NodeSize)
 {
-	// TMap<FVector, FAStarNode> AllNodes = GridNodes;
- //
- //    FVector StartGridCenter = GetGridCenter(Start, NodeSize);
- //    FVector GoalGridCenter = GetGridCenter(Goal, NodeSize);
- //
-	// // FVector StartGridCenter = Start;
-	// // FVector GoalGridCenter = Goal;
- //
- //    // 查找或创建起点和终点节点
- //    FAStarNode* StartNode = &AllNodes.FindOrAdd(StartGridCenter);
- //    FAStarNode* GoalNode = &AllNodes.FindOrAdd(GoalGridCenter);
- //
- //    StartNode->Location = StartGridCenter;
- //    StartNode->bIsWalkable = AllNodes.Contains(StartGridCenter) ? AllNodes[StartGridCenter].bIsWalkable : true;
- //    StartNode->GScore = 0.0f;
- //    StartNode->FScore = Heuristic(StartGridCenter, GoalGridCenter);
- //
- //    GoalNode->Location = GoalGridCenter;
- //    GoalNode->bIsWalkable = AllNodes.Contains(GoalGridCenter) ? AllNodes[GoalGridCenter].bIsWalkable : true;
- //
- //    TSet<FVector> OpenSet;
- //    TSet<FVector> ClosedSet;
- //
- //    OpenSet.Add(StartGridCenter);
- //
- //    while (!OpenSet.IsEmpty())
- //    {
- //        // 找到 FScore 最小的节点（这里简化，实际可用优先队列）
- //        FVector CurrentGridCenter;
- //        FAStarNode* CurrentNode = nullptr;
- //        float LowestFScore = TNumericLimits<float>::Max();
- //
- //        for (const FVector& GridLoc : OpenSet)
- //        {
- //            const FAStarNode* Node = &AllNodes[GridLoc];
- //            if (Node->FScore < LowestFScore)
- //            {
- //                LowestFScore = Node->FScore;
- //                CurrentGridCenter = GridLoc;
- //                CurrentNode = const_cast<FAStarNode*>(Node);
- //            }
- //        }
- //
- //        if (!CurrentNode || CurrentGridCenter == GoalGridCenter)
- //        {
- //            // 找到路径，开始回溯
- //            if (CurrentGridCenter == GoalGridCenter)
- //            {
- //                return RetracePath(AllNodes, StartGridCenter, GoalGridCenter);
- //            }
- //            break;
- //        }
- //
- //        OpenSet.Remove(CurrentGridCenter);
- //        ClosedSet.Add(CurrentGridCenter);
- //
- //        // 遍历邻居
- //        TArray<FVector> Neighbors = GetNeighborGridCenters(CurrentGridCenter, NodeSize);
- //
- //        for (const FVector& NeighborCenter : Neighbors)
- //        {
- //            if (!AllNodes.Contains(NeighborCenter) || !AllNodes[NeighborCenter].bIsWalkable || ClosedSet.Contains(NeighborCenter))
- //                continue;
- //
- //            float TentativeGScore = CurrentNode->GScore + FVector::Dist(CurrentGridCenter, NeighborCenter);
- //
- //            FAStarNode* NeighborNode = &AllNodes[NeighborCenter];
- //
- //            if (TentativeGScore < NeighborNode->GScore)
- //            {
- //                NeighborNode->Parent = CurrentNode;
- //                NeighborNode->GScore = TentativeGScore;
- //                NeighborNode->FScore = TentativeGScore + Heuristic(NeighborCenter, GoalGridCenter);
- //
- //                if (!OpenSet.Contains(NeighborCenter))
- //                {
- //                    OpenSet.Add(NeighborCenter);
- //                }
- //            }
- //        }
- //    }
- //
- //    return {}; // 没找到路径
-	// 复制网格节点（避免修改原始数据）
-    TMap<FVector, FAStarNode> AllNodes = GridNodes;
-
-    // 获取网格中心坐标
-    const FVector StartGridCenter = GetGridCenter(Start, NodeSize);
-    const FVector GoalGridCenter = GetGridCenter(Goal, NodeSize);
-
-    // 查找或创建起点和终点节点
-    FAStarNode& StartNode = AllNodes.FindOrAdd(StartGridCenter);
-    FAStarNode& GoalNode = AllNodes.FindOrAdd(GoalGridCenter);
-
-    // 初始化起点节点
-    StartNode.Location = StartGridCenter;
-    StartNode.bIsWalkable = AllNodes.Contains(StartGridCenter) ? AllNodes[StartGridCenter].bIsWalkable : true;
-    StartNode.GScore = 0.0f;
-    StartNode.FScore = Heuristic(StartGridCenter, GoalGridCenter);
-
-    // 初始化终点节点
-    GoalNode.Location = GoalGridCenter;
-    GoalNode.bIsWalkable = AllNodes.Contains(GoalGridCenter) ? AllNodes[GoalGridCenter].bIsWalkable : true;
-
-    // 使用优先队列优化开放集
-    TArray<FVector> OpenSet;
-    TSet<FVector> ClosedSet;
-
-    // 自定义比较函数用于优先队列
-    auto FScoreComparator = [&AllNodes](const FVector& A, const FVector& B) {
-        return AllNodes[A].FScore < AllNodes[B].FScore;
-    };
-
-    OpenSet.HeapPush(StartGridCenter, FScoreComparator);
-
-    while (!OpenSet.IsEmpty())
-    {
-        // 从优先队列中获取 FScore 最小的节点
-        FVector CurrentGridCenter;
-        OpenSet.HeapPop(CurrentGridCenter, FScoreComparator, EAllowShrinking::No);
-
-        FAStarNode& CurrentNode = AllNodes[CurrentGridCenter];
-
-        // 检查是否到达目标
-        if (CurrentGridCenter.Equals(GoalGridCenter, 1.0f))
-        {
-            return RetracePath(AllNodes, StartGridCenter, GoalGridCenter);
-        }
-
-        ClosedSet.Add(CurrentGridCenter);
-
-        // 获取邻居节点
-        TArray<FVector> Neighbors = GetNeighborGridCenters(CurrentGridCenter, NodeSize);
-
-        for (const FVector& NeighborCenter : Neighbors)
-        {
-            // 跳过无效节点
-            if (!AllNodes.Contains(NeighborCenter) || 
-                !AllNodes[NeighborCenter].bIsWalkable || 
-                ClosedSet.Contains(NeighborCenter))
-            {
-                continue;
-            }
-
-            FAStarNode& NeighborNode = AllNodes[NeighborCenter];
-            const float TentativeGScore = CurrentNode.GScore + 
-                FVector::Dist(CurrentGridCenter, NeighborCenter);
-
-            // 发现更优路径
-            if (TentativeGScore < NeighborNode.GScore)
-            {
-                NeighborNode.Parent = &CurrentNode;
-                NeighborNode.GScore = TentativeGScore;
-                NeighborNode.FScore = TentativeGScore + Heuristic(NeighborCenter, GoalGridCenter);
-
-                // 如果不在开放集中，则添加
-                if (!OpenSet.Contains(NeighborCenter))
-                {
-                    OpenSet.HeapPush(NeighborCenter, FScoreComparator);
-                }
-                else
-                {
-                    // 如果在开放集中，需要重新调整堆
-                    OpenSet.HeapSort(FScoreComparator);
-                }
-            }
-        }
-    }
-
-    return TArray<FVector>(); // 没找到路径
+	FFlightNavQueryStats Stats;
+	return FindPathWithStats(Start, Goal, GridNodes, NodeSize, Stats);
+}
+
+TArray<FVector> UFlightNavigationBFL::FindPathWithStats(const FVector& Start, const FVector& Goal,
+	const TMap<FVector, FAStarNode>& GridNodes, float NodeSize, FFlightNavQueryStats& OutStats,
+	const FFlightNavLandmarks* Landmarks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_FindPath);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_FindPath);
+
+	OutStats = FFlightNavQueryStats();
+	FFlightNavScopedLatency Latency(EFlightNavMetric::FindPath);
+	// 结束时写回耗时并汇总到全局统计
+	ON_SCOPE_EXIT
+	{
+		OutStats.WallTimeMs = static_cast<float>(Latency.GetElapsedMs());
+		FFlightNavMetrics::Get().RecordQuery(OutStats);
+	};
+
+	const FVector StartGridCenter = GetGridCenter(Start, NodeSize);
+	FlightNavSearch::FGoalSet GoalSet;
+	if (!FlightNavSearch::BuildGoalSet(FlightNavNeighborKernel::ToCell(StartGridCenter, NodeSize), MakeArrayView(&Goal, 1),
+		GridNodes, NodeSize, Landmarks, GoalSet))
+	{
+		return TArray<FVector>();
+	}
+
+	int32 GoalIndex = INDEX_NONE;
+	return FlightNavSearch::Search(StartGridCenter, GoalSet, GridNodes, NodeSize, GoalIndex, OutStats);
+}
+
+TArray<FVector> UFlightNavigationBFL::FindPathToNearestGoal(const FVector& Start, TConstArrayView<FVector> Goals,
+	const TMap<FVector, FAStarNode>& GridNodes, float NodeSize, int32& OutGoalIndex, FFlightNavQueryStats& OutStats,
+	const FFlightNavLandmarks* Landmarks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_FindPathToNearestGoal);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_FindPath);
+
+	OutStats = FFlightNavQueryStats();
+	OutGoalIndex = INDEX_NONE;
+	FFlightNavScopedLatency Latency(EFlightNavMetric::FindPath);
+	ON_SCOPE_EXIT
+	{
+		OutStats.WallTimeMs = static_cast<float>(Latency.GetElapsedMs());
+		FFlightNavMetrics::Get().RecordQuery(OutStats);
+	};
+
+	const FVector StartGridCenter = GetGridCenter(Start, NodeSize);
+	FlightNavSearch::FGoalSet GoalSet;
+	if (!FlightNavSearch::BuildGoalSet(FlightNavNeighborKernel::ToCell(StartGridCenter, NodeSize), Goals,
+		GridNodes, NodeSize, Landmarks, GoalSet))
+	{
+		return TArray<FVector>();
+	}
+
+	return FlightNavSearch::Search(StartGridCenter, GoalSet, GridNodes, NodeSize, OutGoalIndex, OutStats);
 }
 
 /**
@@ -301,6 +362,9 @@ TArray<FVector> UFlightNavigationBFL::RetracePath(
 TMap<FVector,FAStarNode> UFlightNavigationBFL::GenerateVoxelGrid(UWorld* World,  FVector& MinBounds,
 	 FVector& MaxBounds, float VoxelSize)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_GenerateVoxelGrid);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_Bake);
+
 	TMap<FVector, FAStarNode> VoxelGrids;
 	for (float X = MinBounds.X; X < MaxBounds.X; X += VoxelSize)
 	{
@@ -313,17 +377,33 @@ TMap<FVector,FAStarNode> UFlightNavigationBFL::GenerateVoxelGrid(UWorld* World,
 
 				VoxelGrids.Add(VoxelCenter, FAStarNode(VoxelCenter, VoxelSize, bWalkable));
 
-				// 可选：可视化每个体素（调试用）
-                #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-				FColor Color = bWalkable ? FColor::Green : FColor::Red;
-				DrawDebugBox(World, VoxelCenter, FVector(VoxelSize * 0.5f), FQuat::Identity, Color, false, 50, 0, 1.0f);
-                #endif
+				// 可视化改由 UFlightNavDebugDrawComponent 批量绘制（FlightNav.Debug.Draw 1）
 			}
 		}
 	}
 	return VoxelGrids;
 }
 
+TMap<FVector, FAStarNode> UFlightNavigationBFL::GenerateVoxelGridFromGeometry(const UWorld* World, const FVector& MinBounds,
+	const FVector& MaxBounds, float VoxelSize)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_GenerateVoxelGridFromGeometry);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_Bake);
+
+	FFlightNavVoxelizer Voxelizer(MinBounds, MaxBounds, VoxelSize);
+	Voxelizer.GatherWorld(World);
+
+	TMap<FVector, FAStarNode> VoxelGrids;
+	if (!Voxelizer.Rasterize(VoxelGrids))
+	{
+		return VoxelGrids;
+	}
+
+	UE_LOG(LogFlightNav, Log, TEXT("Rasterized %d solids and %d triangles into %d voxels."),
+		Voxelizer.GetNumSolids(), Voxelizer.GetNumTriangles(), VoxelGrids.Num());
+	return VoxelGrids;
+}
+
 bool UFlightNavigationBFL::IsLocationWalkable( const UWorld* World, const FVector& Location, float VoxelSize)
 {
 	if (!World) return false;
@@ -358,9 +438,6 @@ bool UFlightNavigationBFL::IsLocationWalkable( const UWorld* World, const FVecto
 		Params
 	);
 
-	// 可选：绘制调试盒（开发时可见）
-	// DrawDebugBox(World, BoxCenter, FVector(BoxHalfExtent, BoxHalfExtent, BoxHalfExtent), FQuat::Identity, FColor::Green, false, 2.0f);
-
 	// 如果有任何一个物体 **阻挡（Blocking）** 了这个盒体区域，那么认为不可行走
 	for (const FOverlapResult& Overlap : Overlaps)
 	{
@@ -381,8 +458,12 @@ void UFlightNavigationBFL::UpdateVoxelsInAllObstructionBox(
 	TArray<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>>& BanFlightNavMeshBoundsVolumes,
 	TMap<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>,TArray<FAStarNode*>>& VexolinBanVoxelGrids,
 	TMap<FVector, FAStarNode>& VoxelGrids,
-	float NodeSize)
+	float NodeSize,
+	TSet<FVector>* OutBakeBlockedCells)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_UpdateVoxelsInAllObstructionBox);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_UpdateBanBox);
+
 	//TMap<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>,TArray<FAStarNode>> VexolinBanVoxelGrids;
 	
 	for ( auto& ObstructionBox : BanFlightNavMeshBoundsVolumes)
@@ -398,11 +479,13 @@ void UFlightNavigationBFL::UpdateVoxelsInAllObstructionBox(
 			if (ObstructionBox->GetBounds().GetBox().IsInside(BanVoxel.Key))
 			{
                 BanVoxelGridS.Add(&BanVoxel.Value);
-				
+
+				// 被几何体阻挡的格子在禁飞盒打开时不能恢复为可通行
+				if (OutBakeBlockedCells && !BanVoxel.Value.bIsWalkable)
+				{
+					OutBakeBlockedCells->Add(BanVoxel.Key);
+				}
 				VoxelGrids[BanVoxel.Key].bIsWalkable = false;
-                #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-				DrawDebugVoxelBlocked( World,BanVoxel.Key, NodeSize);
-                #endif
 			}
 		}
 		VexolinBanVoxelGrids.Add(ObstructionBox,BanVoxelGridS);
@@ -410,13 +493,174 @@ void UFlightNavigationBFL::UpdateVoxelsInAllObstructionBox(
 	}
 }
 
-void UFlightNavigationBFL::DrawDebugVoxelBlocked(const UWorld* World,const FVector& VoxelCenter, float NodeSize)
+FFlightNavDataHandle UFlightNavigationBFL::GetFlightNavDataHandle(const UOctreeFlightComponent* Component)
 {
-	float VoxelSize = NodeSize;
+	return Component ? Component->GetNavDataHandle() : FFlightNavDataHandle();
+}
 
-	DrawDebugBox(World, VoxelCenter, FVector(VoxelSize * 0.5f), FQuat::Identity, FColor::Red, false, 100, 0, 1.0f);
+bool UFlightNavigationBFL::IsFlightNavDataValid(const FFlightNavDataHandle& NavData)
+{
+	return NavData.IsValid();
 }
 
+int32 UFlightNavigationBFL::GetFlightNavCellCount(const FFlightNavDataHandle& NavData)
+{
+	const TMap<FVector, FAStarNode>* Grid = NavData.GetGrid();
+	return Grid ? Grid->Num() : 0;
+}
 
+bool UFlightNavigationBFL::FindFlightNavCell(const FFlightNavDataHandle& NavData, const FVector& WorldLocation, FFlightNavCellInfo& OutCell)
+{
+	const FAStarNode* Node = NavData.FindCell(WorldLocation);
+	if (!Node)
+	{
+		OutCell = FFlightNavCellInfo();
+		return false;
+	}
+	OutCell.Center = Node->Location;
+	OutCell.bIsWalkable = Node->bIsWalkable;
+	return true;
+}
 
+bool UFlightNavigationBFL::IsFlightNavRegionWalkable(const FFlightNavDataHandle& NavData, const FBox& Region, bool bTreatMissingAsBlocked)
+{
+	if (!NavData.IsValid() || !Region.IsValid)
+	{
+		return false;
+	}
+
+	bool bWalkable = true;
+	int64 Visited = 0;
+	NavData.ForEachCellInBox(Region, [&bWalkable, &Visited](const FAStarNode& Node)
+	{
+		++Visited;
+		bWalkable = Node.bIsWalkable;
+		return bWalkable;
+	});
 
+	if (bTreatMissingAsBlocked && bWalkable)
+	{
+		// 访问到的格子数少于 Region 覆盖的格子数，说明有部分在网格外或缺失
+		FIntVector MinCell;
+		FIntVector MaxCell;
+		FlightNavNeighborKernel::ToCellRange(Region, NavData.GetNodeSize(), MinCell, MaxCell);
+		const int64 Expected = int64(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+		bWalkable = Visited == Expected;
+	}
+	return bWalkable;
+}
+
+void UFlightNavigationBFL::CountFlightNavCellsInBox(const FFlightNavDataHandle& NavData, const FBox& Region, int32& OutWalkable, int32& OutBlocked)
+{
+	OutWalkable = 0;
+	OutBlocked = 0;
+	NavData.ForEachCellInBox(Region, [&OutWalkable, &OutBlocked](const FAStarNode& Node)
+	{
+		++(Node.bIsWalkable ? OutWalkable : OutBlocked);
+		return true;
+	});
+}
+
+bool UFlightNavigationBFL::GetFlightNavCellsInBox(const FFlightNavDataHandle& NavData, const FBox& Region, int32 MaxResults,
+	bool bWalkableOnly, TArray<FVector>& OutCenters)
+{
+	OutCenters.Reset();
+	if (MaxResults <= 0)
+	{
+		return false;
+	}
+
+	bool bTruncated = false;
+	NavData.ForEachCellInBox(Region, [&OutCenters, &bTruncated, MaxResults, bWalkableOnly](const FAStarNode& Node)
+	{
+		if (bWalkableOnly && !Node.bIsWalkable)
+		{
+			return true;
+		}
+		if (OutCenters.Num() >= MaxResults)
+		{
+			bTruncated = true;
+			return false;
+		}
+		OutCenters.Add(Node.Location);
+		return true;
+	});
+	return bTruncated;
+}
+
+TArray<FVector> UFlightNavigationBFL::FindPathOnNavData(const FFlightNavDataHandle& NavData, const FVector& Start, const FVector& Goal)
+{
+	const TMap<FVector, FAStarNode>* Grid = NavData.GetGrid();
+	if (!Grid)
+	{
+		return TArray<FVector>();
+	}
+	FFlightNavQueryStats Stats;
+	return FindPathWithStats(Start, Goal, *Grid, NavData.GetNodeSize(), Stats, NavData.GetLandmarks());
+}
+
+TArray<FVector> UFlightNavigationBFL::FindPathToNearestGoalOnNavData(const FFlightNavDataHandle& NavData, const FVector& Start,
+	const TArray<FVector>& Goals, int32& OutGoalIndex)
+{
+	OutGoalIndex = INDEX_NONE;
+	const TMap<FVector, FAStarNode>* Grid = NavData.GetGrid();
+	if (!Grid)
+	{
+		return TArray<FVector>();
+	}
+	FFlightNavQueryStats Stats;
+	return FindPathToNearestGoal(Start, Goals, *Grid, NavData.GetNodeSize(), OutGoalIndex, Stats, NavData.GetLandmarks());
+}
+
+bool UFlightNavigationBFL::HasFlightNavLineOfSight(const FFlightNavDataHandle& NavData, const FVector& Start, const FVector& End, bool bTreatMissingAsBlocked)
+{
+	FFlightNavRayHit Hit;
+	return NavData.IsValid() && !RaycastFlightNav(NavData, Start, End, bTreatMissingAsBlocked, Hit);
+}
+
+bool UFlightNavigationBFL::RaycastFlightNav(const FFlightNavDataHandle& NavData, const FVector& Start, const FVector& End, bool bTreatMissingAsBlocked, FFlightNavRayHit& OutHit)
+{
+	const TMap<FVector, FAStarNode>* Grid = NavData.GetGrid();
+	if (!Grid)
+	{
+		OutHit = FFlightNavRayHit();
+		return false;
+	}
+	return FFlightNavRaycast::Trace(*Grid, NavData.GetNodeSize(), Start, End, bTreatMissingAsBlocked, OutHit);
+}
+
+bool UFlightNavigationBFL::BatchFlightNavLineOfSight(const FFlightNavDataHandle& NavData, const TArray<FFlightNavRaySegment>& Segments,
+	bool bTreatMissingAsBlocked, TArray<bool>& OutVisible)
+{
+	const TMap<FVector, FAStarNode>* Grid = NavData.GetGrid();
+	if (!Grid)
+	{
+		OutVisible.Reset();
+		return false;
+	}
+	FFlightNavRaycast::LineOfSightBatch(*Grid, NavData.GetNodeSize(), Segments, bTreatMissingAsBlocked, OutVisible);
+	return true;
+}
+
+bool UFlightNavigationBFL::BatchFlightNavRaycast(const FFlightNavDataHandle& NavData, const TArray<FFlightNavRaySegment>& Segments,
+	bool bTreatMissingAsBlocked, TArray<FFlightNavRayHit>& OutHits)
+{
+	const TMap<FVector, FAStarNode>* Grid = NavData.GetGrid();
+	if (!Grid)
+	{
+		OutHits.Reset();
+		return false;
+	}
+	FFlightNavRaycast::TraceBatch(*Grid, NavData.GetNodeSize(), Segments, bTreatMissingAsBlocked, OutHits);
+	return true;
+}
+
+FFlightNavLatencySummary UFlightNavigationBFL::GetFlightNavLatencySummary(EFlightNavMetric Metric)
+{
+	return FFlightNavMetrics::Get().GetSummary(Metric);
+}
+
+void UFlightNavigationBFL::ResetFlightNavMetrics()
+{
+	FFlightNavMetrics::Get().Reset();
+}
@@ -2,47 +2,202 @@
 
 
 #include "OctreeFlightComponent.h"
-#include "DrawDebugHelpers.h"
 #include "Async/Async.h"
 #include "BanFlightNavMeshBoundsVolume.h"
 #include "FlightNavigationBFL.h"
+#include "FlightNavDebugDrawComponent.h"
+#include "FlightNavCooperativePlanner.h"
+#include "FlightNavWorldSubsystem.h"
+#include "FlightNavRecorder.h"
+#include "FlightNavNeighborKernel.h"
+#include "Engine/World.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 
 UOctreeFlightComponent::UOctreeFlightComponent()
 {
 	FlightNavMeshBoundsVolume = nullptr;
+
+	// 只在 Anytime 寻路进行时开启 Tick
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UOctreeFlightComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!bAnytimeSearchActive || !AnytimeSearch.IsValid())
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	const EFlightNavAnytimeStatus Status = AnytimeSearch->Step(AnytimeExpansionsPerFrame);
+	if (Status == EFlightNavAnytimeStatus::Searching)
+	{
+		return;
+	}
+
+	const bool bIsFinal = Status != EFlightNavAnytimeStatus::Improved;
+	Path = AnytimeSearch->GetBestPath();
+	LastQueryStats = AnytimeSearch->GetStats();
+	UpdatePathSubscription();
+
+	if (bIsFinal)
+	{
+		bAnytimeSearchActive = false;
+		SetComponentTickEnabled(false);
+	}
+
+	RefreshDebugDraw();
+	OnAnytimePathImproved.Broadcast(Path, AnytimeSearch->GetSuboptimalityBound(), bIsFinal);
+}
+
+void UOctreeFlightComponent::BeginAnytimeFlightPath()
+{
+	// NodeSize 可能随重新烘焙改变，每次都重新创建搜索对象
+	AnytimeSearch = MakeUnique<FFlightNavAnytimeSearch>(VoxelGrids, NodeSize, Landmarks.IsValid() ? &Landmarks : nullptr);
+	AnytimeSearch->Begin(Start, Goal, AnytimeInitialEpsilon, AnytimeEpsilonStep);
+	bAnytimeSearchActive = true;
+	SetComponentTickEnabled(true);
+}
+
+void UOctreeFlightComponent::CancelAnytimeFlightPath()
+{
+	bAnytimeSearchActive = false;
+	SetComponentTickEnabled(false);
+}
+
+void UOctreeFlightComponent::RestartAnytimeSearchIfActive()
+{
+	if (!bAnytimeSearchActive)
+	{
+		return;
+	}
+	BeginAnytimeFlightPath();
 }
 
 TArray<FVector> UOctreeFlightComponent::FindFlightPath()
 {
-	
-	Path = UFlightNavigationBFL::FindPath(Start, Goal, VoxelGrids);
+	if (bUseCooperativePlanning)
+	{
+		// 协同路径与时间片有关，由协同规划器单独搜索并写入预约表
+		return FindCooperativeFlightPath();
+	}
+
+	Path = UFlightNavigationBFL::FindPathWithStats(Start, Goal, VoxelGrids, NodeSize, LastQueryStats,
+		Landmarks.IsValid() ? &Landmarks : nullptr);
+	UpdatePathSubscription();
+	FFlightNavRecorder::Get().RecordPathQuery(*this, Start, Goal, Path, LastQueryStats);
+
+	UE_LOG(LogFlightNav, Verbose, TEXT("FindFlightPath: %d points, %d nodes expanded, %.3f ms"),
+		Path.Num(), LastQueryStats.NodesExpanded, LastQueryStats.WallTimeMs);
     #if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 	for (const FVector& P : Path)
 	{
-       
-		UE_LOG(LogTemp, Warning, TEXT("Path Point: %s"), *P.ToString());
-		DrawDebugSphere(GetWorld(), P, 10, 8, FColor::Red, false, 5, 0);
+		UE_LOG(LogFlightNav, VeryVerbose, TEXT("Path Point: %s"), *P.ToString());
 	}
     #endif
+	RefreshDebugDraw();
+	return Path;
+}
+
+TArray<FVector> UOctreeFlightComponent::FindFlightPathToNearest(const TArray<FVector>& Goals, int32& OutGoalIndex)
+{
+	Path = UFlightNavigationBFL::FindPathToNearestGoal(Start, Goals, VoxelGrids, NodeSize, OutGoalIndex, LastQueryStats,
+		Landmarks.IsValid() ? &Landmarks : nullptr);
+	// 当前终点改为选中的目标，之后的 FindFlightPath、Anytime 与协同寻路都以它为终点
+	if (Goals.IsValidIndex(OutGoalIndex))
+	{
+		Goal = Goals[OutGoalIndex];
+	}
+	UpdatePathSubscription();
+
+	UE_LOG(LogFlightNav, Verbose, TEXT("FindFlightPathToNearest: goal %d of %d, %d points, %d nodes expanded, %.3f ms"),
+		OutGoalIndex, Goals.Num(), Path.Num(), LastQueryStats.NodesExpanded, LastQueryStats.WallTimeMs);
+	RefreshDebugDraw();
+	return Path;
+}
+
+TArray<FVector> UOctreeFlightComponent::FindCooperativeFlightPath()
+{
+	UFlightNavWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UFlightNavWorldSubsystem>() : nullptr;
+	if (!Subsystem)
+	{
+		return TArray<FVector>();
+	}
+
+	FFlightNavReservationTable& ReservationTable = Subsystem->GetReservationTable();
+	Subsystem->PruneExpiredReservations();
+	ReservationTable.Release(CooperativeReservations, GetUniqueID());
+
+	FFlightNavCooperativeRequest Request;
+	Request.Start = Start;
+	Request.Goal = Goal;
+	Request.StartTimeSlot = Subsystem->GetCurrentTimeSlot();
+	Request.Window = CooperativeWindow;
+	Request.AgentId = GetUniqueID();
+
+	Path = FFlightNavCooperativePlanner::Plan(VoxelGrids, NodeSize, ReservationTable, Request, CooperativeReservations, LastQueryStats);
+	UpdatePathSubscription();
+
+	UE_LOG(LogFlightNav, Verbose, TEXT("FindCooperativeFlightPath: %d points, %d reservations, %d nodes expanded, %.3f ms"),
+		Path.Num(), CooperativeReservations.Num(), LastQueryStats.NodesExpanded, LastQueryStats.WallTimeMs);
+	RefreshDebugDraw();
 	return Path;
 }
 
-TMap<FVector, FAStarNode> UOctreeFlightComponent::InitializeGenerateFlightNavMesh()
+void UOctreeFlightComponent::ReleaseCooperativeReservations()
+{
+	if (UFlightNavWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UFlightNavWorldSubsystem>() : nullptr)
+	{
+		Subsystem->GetReservationTable().Release(CooperativeReservations, GetUniqueID());
+	}
+	CooperativeReservations.Reset();
+}
+
+void UOctreeFlightComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseCooperativeReservations();
+	CancelAnytimeFlightPath();
+	// 网格随组件销毁，订阅在它上面的路径全部失效；先退订自己的路径，销毁时不再广播 OnFlightPathInvalidated
+	if (FFlightNavPathIndex* PathIndex = GetPathIndex())
+	{
+		PathIndex->Unsubscribe(PathSubscriptionId);
+		PathIndex->InvalidateGrid(GetUniqueID());
+	}
+	PathSubscriptionId = INDEX_NONE;
+	Super::EndPlay(EndPlayReason);
+}
+
+FFlightNavDataHandle UOctreeFlightComponent::InitializeGenerateFlightNavMesh()
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_InitializeGenerateFlightNavMesh);
+	FFlightNavScopedLatency Latency(EFlightNavMetric::Bake);
+
 	VoxelGrids.Empty();
-	if (IsValid(FlightNavMeshBoundsVolume.Get()))
-	{
-		 NavMeshMinBounds = FlightNavMeshBoundsVolume->GetBounds().GetBox().GetCenter()-FlightNavMeshBoundsVolume->GetBounds().GetBox().GetExtent();
-		 NavMeshMaxBounds = FlightNavMeshBoundsVolume->GetBounds().GetBox().GetCenter()+FlightNavMeshBoundsVolume->GetBounds().GetBox().GetExtent();
-		//
-		NavMeshMinBounds = FVector (FIntVector(NavMeshMinBounds/NodeSize) * NodeSize);
-		NavMeshMaxBounds = FVector (FIntVector(NavMeshMaxBounds/NodeSize) * NodeSize);
-		VoxelGrids = UFlightNavigationBFL::GenerateVoxelGrid(GetWorld(), NavMeshMinBounds, NavMeshMaxBounds, NodeSize);
+	// 禁飞盒格子列表指向旧网格，重新烘焙前一并清空
+	VexolinBanVoxelGrids.Reset();
+	BanVoxelGrids.Reset();
+	BakeBlockedBanCells.Reset();
+	if (ComputeNavMeshBounds(NavMeshMinBounds, NavMeshMaxBounds))
+	{
+		VoxelGrids = Voxelizer == EFlightNavVoxelizer::GeometryRasterization
+			? UFlightNavigationBFL::GenerateVoxelGridFromGeometry(GetWorld(), NavMeshMinBounds, NavMeshMaxBounds, NodeSize)
+			: UFlightNavigationBFL::GenerateVoxelGrid(GetWorld(), NavMeshMinBounds, NavMeshMaxBounds, NodeSize);
+		// 地标距离表在禁飞盒生效之前计算；禁飞盒打开时只恢复烘焙时的状态，可通行格子不会超出建表时的集合，下界保持可采纳
+		Landmarks.Build(VoxelGrids, NodeSize, NumLandmarks);
+		FFlightNavRecorder::Get().RecordBake(*this);
 	} 
 	else
 	{
-		return TMap<FVector, FAStarNode>();
+		Landmarks.Reset();
+		if (FFlightNavPathIndex* PathIndex = GetPathIndex())
+		{
+			PathIndex->InvalidateGrid(GetUniqueID());
+		}
+		return FFlightNavDataHandle();
 	}
 
 	if (BanFlightNavMeshBoundsVolumes.Num() > 0)
@@ -56,55 +211,194 @@ TMap<FVector, FAStarNode> UOctreeFlightComponent::InitializeGenerateFlightNavMes
 			}
 		}
 		
-		UFlightNavigationBFL::UpdateVoxelsInAllObstructionBox( GetWorld(),BanFlightNavMeshBoundsVolumes,VexolinBanVoxelGrids, VoxelGrids, NodeSize);
+		UFlightNavigationBFL::UpdateVoxelsInAllObstructionBox( GetWorld(),BanFlightNavMeshBoundsVolumes,VexolinBanVoxelGrids, VoxelGrids, NodeSize, &BakeBlockedBanCells);
+		if (FFlightNavRecorder::IsRecording())
+		{
+			for (const TPair<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>, TArray<FAStarNode*>>& BanBox : VexolinBanVoxelGrids)
+			{
+				FFlightNavRecorder::Get().RecordCellsChanged(*this, BanBox.Value, false);
+			}
+		}
 	}
-	
-	return VoxelGrids;
+
+	// 新网格和禁飞盒都已就绪后再通知，回调中重新寻路得到的是新网格上的路径
+	if (FFlightNavPathIndex* PathIndex = GetPathIndex())
+	{
+		PathIndex->InvalidateGrid(GetUniqueID());
+	}
+	RestartAnytimeSearchIfActive();
+	RefreshDebugDraw();
+	return GetNavDataHandle();
+}
+
+bool UOctreeFlightComponent::ComputeNavMeshBounds(FVector& OutMinBounds, FVector& OutMaxBounds) const
+{
+	if (!IsValid(FlightNavMeshBoundsVolume.Get()))
+	{
+		return false;
+	}
+	 OutMinBounds = FlightNavMeshBoundsVolume->GetBounds().GetBox().GetCenter()-FlightNavMeshBoundsVolume->GetBounds().GetBox().GetExtent();
+	 OutMaxBounds = FlightNavMeshBoundsVolume->GetBounds().GetBox().GetCenter()+FlightNavMeshBoundsVolume->GetBounds().GetBox().GetExtent();
+	//
+	OutMinBounds = FVector (FIntVector(OutMinBounds/NodeSize) * NodeSize);
+	OutMaxBounds = FVector (FIntVector(OutMaxBounds/NodeSize) * NodeSize);
+	return true;
 }
 
 void UOctreeFlightComponent::UpdateVoxelsInObstructionBox(FVector BanboxCenter, bool bIsBlocked)
 {
-	bool bIsPath = false;
+	TRACE_CPUPROFILER_EVENT_SCOPE(FlightNav_UpdateVoxelsInObstructionBox);
+	SCOPE_CYCLE_COUNTER(STAT_FlightNav_UpdateBanBox);
+	FFlightNavScopedLatency Latency(EFlightNavMetric::BanBoxUpdate);
+
 	if (BanFlightNavMeshBoundsVolumes.Num() == 0 || VoxelGrids.Num() == 0 )
 	{
-		UE_LOG(LogTemp, Warning, TEXT("ObstructionBox is invalid or VoxelGrid is empty."));
+		UE_LOG(LogFlightNav, Warning, TEXT("ObstructionBox is invalid or VoxelGrid is empty."));
 		return;
 	}
 	TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>& Banbox = *BanVoxelGrids.Find(BanboxCenter);
 	
-	for (FAStarNode* BanVoxel : *VexolinBanVoxelGrids.Find(Banbox))
+	const TArray<FAStarNode*>& BanVoxels = *VexolinBanVoxelGrids.Find(Banbox);
+	TArray<FAStarNode*> ChangedVoxels;
+	TArray<FIntVector> ChangedCells;
+	ChangedVoxels.Reserve(BanVoxels.Num());
+	ChangedCells.Reserve(BanVoxels.Num());
+	for (FAStarNode* BanVoxel : BanVoxels)
 	{
+		// 只恢复烘焙时的可通行状态，不能打开被几何体阻挡的格子（否则地标下界不再可采纳）
+		if (bIsBlocked && BakeBlockedBanCells.Contains(BanVoxel->Location))
+		{
+			continue;
+		}
 		BanVoxel->bIsWalkable = bIsBlocked;
-		if (Path.Num()>0)
+		ChangedVoxels.Add(BanVoxel);
+		ChangedCells.Add(FlightNavNeighborKernel::ToCell(BanVoxel->Location, NodeSize));
+	}
+	FFlightNavRecorder::Get().RecordCellsChanged(*this, ChangedVoxels, bIsBlocked);
+
+	// 当前路径的订阅在上一次关闭时可能已被移除，是否经过改用 Path 本身判断
+	bool bIsPath = false;
+	if (Path.Num() > 0 && ChangedCells.Num() > 0)
+	{
+		TSet<FIntVector> PathCells;
+		PathCells.Reserve(Path.Num());
+		for (const FVector& Point : Path)
 		{
-			for (FVector P : Path)
+			PathCells.Add(FlightNavNeighborKernel::ToCell(Point, NodeSize));
+		}
+		for (const FIntVector& Cell : ChangedCells)
+		{
+			if (PathCells.Contains(Cell))
 			{
-				if (P == BanVoxel->Location)
-				{
-					bIsPath = true;
-				}
+				bIsPath = true;
+				break;
 			}
 		}
 	}
+
+	// 只查找被修改的格子通知订阅的路径；格子重新变为可通行不会让已有路径失效
+	if (!bIsBlocked)
+	{
+		if (FFlightNavPathIndex* PathIndex = GetPathIndex())
+		{
+			TMap<int32, FFlightNavPathInvalidation> Affected;
+			PathIndex->CollectAffected(GetUniqueID(), ChangedCells, Affected);
+			PathIndex->Invalidate(Affected);
+		}
+	}
 	
+	RestartAnytimeSearchIfActive();
+	RefreshDebugDraw();
 	BroadcastVoxelStateChanged(bIsPath);
 }
 
+void UOctreeFlightComponent::GetBanClosedVoxels(TArray<const FAStarNode*>& OutVoxels) const
+{
+	OutVoxels.Reset();
+	// 禁飞盒可能重叠，同一格子只输出一次
+	TSet<const FAStarNode*> Seen;
+	for (const TPair<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>, TArray<FAStarNode*>>& BanBox : VexolinBanVoxelGrids)
+	{
+		for (const FAStarNode* BanVoxel : BanBox.Value)
+		{
+			if (!BanVoxel->bIsWalkable && !BakeBlockedBanCells.Contains(BanVoxel->Location) && !Seen.Contains(BanVoxel))
+			{
+				Seen.Add(BanVoxel);
+				OutVoxels.Add(BanVoxel);
+			}
+		}
+	}
+}
+
+int32 UOctreeFlightComponent::SubscribePath(const TArray<FVector>& AgentPath, FOnFlightNavPathInvalidated OnInvalidated)
+{
+	FFlightNavPathIndex* PathIndex = GetPathIndex();
+	if (!PathIndex || !OnInvalidated.IsBound())
+	{
+		return INDEX_NONE;
+	}
+	// 绑定到回调对象的弱引用上，对象销毁后索引可以清理这条订阅
+	return PathIndex->Subscribe(GetUniqueID(), NodeSize, AgentPath,
+		FOnFlightNavPathInvalidatedNative::CreateWeakLambda(OnInvalidated.GetUObject(), [OnInvalidated](const FFlightNavPathInvalidation& Invalidation)
+		{
+			OnInvalidated.ExecuteIfBound(Invalidation);
+		}));
+}
+
+void UOctreeFlightComponent::UnsubscribePath(int32 SubscriptionId)
+{
+	if (FFlightNavPathIndex* PathIndex = GetPathIndex())
+	{
+		PathIndex->Unsubscribe(SubscriptionId);
+	}
+}
+
+void UOctreeFlightComponent::UpdatePathSubscription()
+{
+	FFlightNavPathIndex* PathIndex = GetPathIndex();
+	if (!PathIndex)
+	{
+		return;
+	}
+
+	PathIndex->Unsubscribe(PathSubscriptionId);
+	PathSubscriptionId = PathIndex->Subscribe(GetUniqueID(), NodeSize, Path,
+		FOnFlightNavPathInvalidatedNative::CreateWeakLambda(this, [this](const FFlightNavPathInvalidation& Invalidation)
+		{
+			PathSubscriptionId = INDEX_NONE;
+			OnFlightPathInvalidated.Broadcast(Invalidation);
+		}));
+}
+
+FFlightNavPathIndex* UOctreeFlightComponent::GetPathIndex() const
+{
+	UFlightNavWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UFlightNavWorldSubsystem>() : nullptr;
+	return Subsystem ? &Subsystem->GetPathIndex() : nullptr;
+}
+
 FVector UOctreeFlightComponent::GetBanBoxCenter(TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>& BanBox)
 {
 	return BanBox.Get()->GetBounds().GetBox().GetCenter();
 }
 
-void UOctreeFlightComponent::DrawDebugVoxelBlocked(const FAStarNode& Voxel)
+void UOctreeFlightComponent::RefreshDebugDraw()
 {
-	float VoxelSize = Voxel.NodeSize;
-	FVector VoxelCenter = Voxel.Location;
-
-	//DrawDebugBox(GetWorld(), VoxelCenter, FVector(VoxelSize * 0.5f), FQuat::Identity, FColor::Red, false, 100, 0, 1.0f);
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	AActor* Owner = GetOwner();
+	if (!Owner || !GetWorld() || !UFlightNavDebugDrawComponent::IsDebugDrawEnabled())
+	{
+		return;
+	}
 
-	bool bWalkable = Voxel.bIsWalkable;
-	FColor Color = bWalkable ? FColor::Green : FColor::Red;
-	DrawDebugBox(GetWorld(), VoxelCenter, FVector(VoxelSize * 0.5f), FQuat::Identity, Color, false, 50, 0, 1.0f);
+	// 第一次在调试绘制打开时创建，之后是否生成渲染数据由 FlightNav.Debug.Draw 决定
+	if (!DebugDrawComponent)
+	{
+		DebugDrawComponent = NewObject<UFlightNavDebugDrawComponent>(Owner, NAME_None, RF_Transient);
+		DebugDrawComponent->SetSourceComponent(this);
+		DebugDrawComponent->RegisterComponent();
+	}
+	DebugDrawComponent->RefreshDebugDraw();
+#endif
 }
 
 void UOctreeFlightComponent::BroadcastVoxelStateChanged(bool bIsPath )
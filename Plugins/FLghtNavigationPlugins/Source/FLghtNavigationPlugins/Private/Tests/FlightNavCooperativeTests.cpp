@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestGrid.h"
+#include "FlightNavCooperativePlanner.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavCooperativeTests
+{
+	static constexpr uint32 AgentA = 1;
+	static constexpr uint32 AgentB = 2;
+	static constexpr int32 Window = 16;
+
+	static TArray<FVector> Plan(const TMap<FVector, FAStarNode>& Grid, FFlightNavReservationTable& ReservationTable,
+		const FIntVector& StartCell, const FIntVector& GoalCell, uint32 AgentId, TArray<FFlightNavSpaceTimeKey>& OutReservations)
+	{
+		FFlightNavCooperativeRequest Request;
+		Request.Start = FlightNavTest::CellCenter(StartCell);
+		Request.Goal = FlightNavTest::CellCenter(GoalCell);
+		Request.StartTimeSlot = 0;
+		Request.Window = Window;
+		Request.AgentId = AgentId;
+
+		FFlightNavQueryStats Stats;
+		return FFlightNavCooperativePlanner::Plan(Grid, FlightNavTest::NodeSize, ReservationTable, Request, OutReservations, Stats);
+	}
+
+	// 第 Step 个时间片所在的格子；路径在窗口内到达终点后停在终点
+	static FIntVector CellAt(const TArray<FVector>& Path, int32 Step)
+	{
+		return FlightNavNeighborKernel::ToCell(Path[FMath::Min(Step, Path.Num() - 1)], FlightNavTest::NodeSize);
+	}
+
+	// 窗口内两条路径既不同时占用同一格子，也不在相邻两个时间片互换位置
+	static void TestNoConflicts(FAutomationTestBase& Test, const TArray<FVector>& PathA, const TArray<FVector>& PathB)
+	{
+		for (int32 Step = 0; Step <= Window; ++Step)
+		{
+			Test.TestNotEqual(FString::Printf(TEXT("Agents share a cell at step %d"), Step), CellAt(PathA, Step), CellAt(PathB, Step));
+			if (Step < Window)
+			{
+				const bool bSwap = CellAt(PathA, Step) == CellAt(PathB, Step + 1) && CellAt(PathA, Step + 1) == CellAt(PathB, Step);
+				Test.TestFalse(FString::Printf(TEXT("Agents swap cells between steps %d and %d"), Step, Step + 1), bSwap);
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavCooperativeHeadOnTest, "FlightNavigation.Cooperative.HeadOnSwap",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavCooperativeHeadOnTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+	using namespace FlightNavCooperativeTests;
+
+	// 两条车道的走廊，两个智能体从两端相向而行，后规划的一方必须换道让行
+	{
+		const TMap<FVector, FAStarNode> Grid = MakeGrid(FIntVector(6, 2, 1));
+		FFlightNavReservationTable ReservationTable;
+		TArray<FFlightNavSpaceTimeKey> ReservationsA;
+		TArray<FFlightNavSpaceTimeKey> ReservationsB;
+		const TArray<FVector> PathA = Plan(Grid, ReservationTable, FIntVector(0, 0, 0), FIntVector(5, 0, 0), AgentA, ReservationsA);
+		const TArray<FVector> PathB = Plan(Grid, ReservationTable, FIntVector(5, 0, 0), FIntVector(0, 0, 0), AgentB, ReservationsB);
+		if (!TestTrue(TEXT("Both agents get a path"), PathA.Num() > 0 && PathB.Num() > 0))
+		{
+			return false;
+		}
+		TestEqual(TEXT("Agent A reaches its goal"), PathA.Last(), CellCenter(FIntVector(5, 0, 0)));
+		TestEqual(TEXT("Agent B reaches its goal"), PathB.Last(), CellCenter(FIntVector(0, 0, 0)));
+		TestTrue(TEXT("Agent B moves to the other lane"), PathB.ContainsByPredicate([](const FVector& Point)
+		{
+			return FlightNavNeighborKernel::ToCell(Point, NodeSize).Y == 1;
+		}));
+		TestNoConflicts(*this, PathA, PathB);
+	}
+
+	// 单格宽、两格长的走廊：唯一的走法是互换位置，第二个智能体不能得到路径
+	{
+		const TMap<FVector, FAStarNode> Grid = MakeGrid(FIntVector(2, 1, 1));
+		FFlightNavReservationTable ReservationTable;
+		TArray<FFlightNavSpaceTimeKey> ReservationsA;
+		TArray<FFlightNavSpaceTimeKey> ReservationsB;
+		const TArray<FVector> PathA = Plan(Grid, ReservationTable, FIntVector(0, 0, 0), FIntVector(1, 0, 0), AgentA, ReservationsA);
+		const TArray<FVector> PathB = Plan(Grid, ReservationTable, FIntVector(1, 0, 0), FIntVector(0, 0, 0), AgentB, ReservationsB);
+		TestTrue(TEXT("First agent gets a path"), PathA.Num() > 0);
+		TestEqual(TEXT("Second agent cannot swap through it"), PathB.Num(), 0);
+		TestEqual(TEXT("Failed plan reserves nothing"), ReservationsB.Num(), 0);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavCooperativeReservationTest, "FlightNavigation.Cooperative.ReservationConflicts",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavCooperativeReservationTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+	using namespace FlightNavCooperativeTests;
+
+	// 预约表：别人的预约不能覆盖，也不能被别人释放
+	{
+		FFlightNavReservationTable ReservationTable;
+		const FFlightNavSpaceTimeKey Key(FIntVector(3, 1, 0), 7);
+		TestTrue(TEXT("Free cell can be reserved"), ReservationTable.TryReserve(Key.Cell, Key.TimeSlot, AgentA));
+		TestTrue(TEXT("Owner can reserve again"), ReservationTable.TryReserve(Key.Cell, Key.TimeSlot, AgentA));
+		TestFalse(TEXT("Other agent cannot take the reservation"), ReservationTable.TryReserve(Key.Cell, Key.TimeSlot, AgentB));
+		TestEqual(TEXT("Owner is kept"), ReservationTable.GetOwner(Key.Cell, Key.TimeSlot), AgentA);
+
+		ReservationTable.Release(MakeArrayView(&Key, 1), AgentB);
+		TestEqual(TEXT("Other agent cannot release it"), ReservationTable.GetOwner(Key.Cell, Key.TimeSlot), AgentA);
+		ReservationTable.Release(MakeArrayView(&Key, 1), AgentA);
+		TestEqual(TEXT("Owner releases it"), ReservationTable.GetOwner(Key.Cell, Key.TimeSlot), FFlightNavReservationTable::NoAgent);
+		TestEqual(TEXT("Table is empty"), ReservationTable.Num(), 0);
+	}
+
+	// 两条交叉的路线：预约互不重叠，释放一方不影响另一方
+	const TMap<FVector, FAStarNode> Grid = MakeGrid(FIntVector(5, 5, 1));
+	FFlightNavReservationTable ReservationTable;
+	TArray<FFlightNavSpaceTimeKey> ReservationsA;
+	TArray<FFlightNavSpaceTimeKey> ReservationsB;
+	const TArray<FVector> PathA = Plan(Grid, ReservationTable, FIntVector(0, 2, 0), FIntVector(4, 2, 0), AgentA, ReservationsA);
+	const TArray<FVector> PathB = Plan(Grid, ReservationTable, FIntVector(2, 0, 0), FIntVector(2, 4, 0), AgentB, ReservationsB);
+	if (!TestTrue(TEXT("Both agents get a path"), PathA.Num() > 0 && PathB.Num() > 0))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Agent A reserves every step of the window"), ReservationsA.Num(), Window + 1);
+	TestEqual(TEXT("Agent B reserves every step of the window"), ReservationsB.Num(), Window + 1);
+	TestNoConflicts(*this, PathA, PathB);
+
+	for (const FFlightNavSpaceTimeKey& Key : ReservationsA)
+	{
+		TestEqual(TEXT("Agent A owns its reservations"), ReservationTable.GetOwner(Key.Cell, Key.TimeSlot), AgentA);
+		TestFalse(TEXT("Reservations do not overlap"), ReservationsB.Contains(Key));
+	}
+
+	ReservationTable.Release(ReservationsA, AgentA);
+	for (const FFlightNavSpaceTimeKey& Key : ReservationsA)
+	{
+		TestEqual(TEXT("Released reservations are free"), ReservationTable.GetOwner(Key.Cell, Key.TimeSlot), FFlightNavReservationTable::NoAgent);
+	}
+	for (const FFlightNavSpaceTimeKey& Key : ReservationsB)
+	{
+		TestEqual(TEXT("Agent B keeps its reservations"), ReservationTable.GetOwner(Key.Cell, Key.TimeSlot), AgentB);
+	}
+	TestEqual(TEXT("Only agent B is left in the table"), ReservationTable.Num(), ReservationsB.Num());
+
+	// 没有智能体 ID 的请求不规划也不预约
+	TArray<FFlightNavSpaceTimeKey> Reservations;
+	TestEqual(TEXT("Request without an agent is rejected"),
+		Plan(Grid, ReservationTable, FIntVector(0, 0, 0), FIntVector(4, 4, 0), FFlightNavReservationTable::NoAgent, Reservations).Num(), 0);
+	return true;
+}
+
+#endif
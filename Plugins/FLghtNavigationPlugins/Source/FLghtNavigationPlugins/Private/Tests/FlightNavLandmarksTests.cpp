@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestGrid.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavLandmarks.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavLandmarksTests
+{
+	static TArray<FIntVector> SampleCells()
+	{
+		return {
+			FIntVector(0, 0, 0), FIntVector(2, 5, 0), FIntVector(5, 0, 0), FIntVector(5, 6, 0), FIntVector(6, 7, 0),
+			FIntVector(7, 0, 0), FIntVector(9, 3, 0), FIntVector(11, 0, 0), FIntVector(11, 7, 0), FIntVector(3, 3, 0)
+		};
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavLandmarksLowerBoundTest, "FlightNavigation.Landmarks.LowerBoundIsAdmissible",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavLandmarksLowerBoundTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	// 12 x 8 的平面网格，X = 6 处的墙只在 Y = 7 留缺口，欧几里得距离明显低估绕行距离
+	const TMap<FVector, FAStarNode> Grid = MakeWallGrid(FIntVector(12, 8, 1), 6, 7);
+	FFlightNavLandmarks Landmarks;
+	Landmarks.Build(Grid, NodeSize, 4);
+	TestEqual(TEXT("Landmark count"), Landmarks.Num(), 4);
+
+	const TArray<FIntVector> Cells = FlightNavLandmarksTests::SampleCells();
+	bool bTighterSomewhere = false;
+	for (const FIntVector& GoalCell : Cells)
+	{
+		TArray<float> GoalDistances;
+		if (!TestTrue(TEXT("Goal is in the distance table"), Landmarks.PrepareGoal(CellCenter(GoalCell), GoalDistances)))
+		{
+			return false;
+		}
+
+		for (const FIntVector& Cell : Cells)
+		{
+			FFlightNavQueryStats Stats;
+			const TArray<FVector> Path = UFlightNavigationBFL::FindPathWithStats(CellCenter(Cell), CellCenter(GoalCell), Grid, NodeSize, Stats);
+			TestTrue(FString::Printf(TEXT("%s -> %s reachable"), *Cell.ToString(), *GoalCell.ToString()), Path.Num() > 0);
+			const float Distance = PathLength(Path);
+
+			const float Bound = Landmarks.GetLowerBound(CellCenter(Cell), GoalDistances);
+			TestTrue(FString::Printf(TEXT("Lower bound %s -> %s (%.2f) <= distance (%.2f)"), *Cell.ToString(), *GoalCell.ToString(), Bound, Distance),
+				Bound <= Distance + LengthTolerance);
+			bTighterSomewhere |= Bound > FVector::Dist(CellCenter(Cell), CellCenter(GoalCell)) + LengthTolerance;
+
+			// ALT 只改变展开顺序，路径长度必须与欧几里得启发函数一致
+			FFlightNavQueryStats LandmarkStats;
+			const TArray<FVector> LandmarkPath = UFlightNavigationBFL::FindPathWithStats(CellCenter(Cell), CellCenter(GoalCell), Grid, NodeSize, LandmarkStats, &Landmarks);
+			TestNearlyEqual(FString::Printf(TEXT("ALT path length %s -> %s"), *Cell.ToString(), *GoalCell.ToString()), PathLength(LandmarkPath), Distance, LengthTolerance);
+		}
+	}
+	TestTrue(TEXT("Landmarks beat the Euclidean distance around the wall"), bTighterSomewhere);
+	return true;
+}
+
+#endif
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestGrid.h"
+#include "FlightNavigationBFL.h"
+#include "FlightNavLandmarks.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavMultiGoalTests
+{
+	// 逐个目标单独寻路得到的最短路径长度，没有可达目标时返回 -1
+	static float NearestByEnumeration(const FVector& Start, TConstArrayView<FVector> Goals, const TMap<FVector, FAStarNode>& Grid)
+	{
+		float Nearest = -1.0f;
+		for (const FVector& Goal : Goals)
+		{
+			FFlightNavQueryStats Stats;
+			const TArray<FVector> Path = UFlightNavigationBFL::FindPathWithStats(Start, Goal, Grid, FlightNavTest::NodeSize, Stats);
+			if (Path.Num() > 0 && (Nearest < 0.0f || FlightNavTest::PathLength(Path) < Nearest))
+			{
+				Nearest = FlightNavTest::PathLength(Path);
+			}
+		}
+		return Nearest;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavMultiGoalNearestTest, "FlightNavigation.MultiGoal.PicksNearestByPathCost",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavMultiGoalNearestTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	// 10 x 10 的平面网格，X = 2 处的墙只在 Y = 9 留缺口
+	TMap<FVector, FAStarNode> Grid = MakeWallGrid(FIntVector(10, 10, 1), 2, 9);
+	const FVector Start = CellCenter(FIntVector(0, 0, 0));
+
+	// 目标 0 欧几里得距离最近但在墙后，目标 1 按路径代价最近
+	const TArray<FVector> Goals = { CellCenter(FIntVector(3, 0, 0)), CellCenter(FIntVector(0, 6, 0)), CellCenter(FIntVector(9, 9, 0)) };
+	int32 GoalIndex = INDEX_NONE;
+	FFlightNavQueryStats Stats;
+	TArray<FVector> Path = UFlightNavigationBFL::FindPathToNearestGoal(Start, Goals, Grid, NodeSize, GoalIndex, Stats);
+	TestEqual(TEXT("Goal behind the wall is not chosen"), GoalIndex, 1);
+	TestNearlyEqual(TEXT("Path length"), PathLength(Path), 600.0f, LengthTolerance);
+	if (Path.Num() > 0)
+	{
+		TestEqual(TEXT("Path starts at the start cell"), Path[0], Start);
+		TestEqual(TEXT("Path ends at the chosen goal"), Path.Last(), Goals[1]);
+	}
+
+	// 不可通行的目标被忽略；同一格子的多个目标取第一个
+	SetWalkable(Grid, FIntVector(0, 6, 0), false);
+	const TArray<FVector> DuplicateGoals = { CellCenter(FIntVector(0, 6, 0)), CellCenter(FIntVector(9, 9, 0)), CellCenter(FIntVector(9, 9, 0)) + FVector(10.0) };
+	Path = UFlightNavigationBFL::FindPathToNearestGoal(Start, DuplicateGoals, Grid, NodeSize, GoalIndex, Stats);
+	TestEqual(TEXT("Blocked goal is skipped and the first duplicate wins"), GoalIndex, 1);
+
+	// 全部目标不可通行时没有路径
+	const TArray<FVector> BlockedGoals = { CellCenter(FIntVector(0, 6, 0)), CellCenter(FIntVector(2, 3, 0)) };
+	Path = UFlightNavigationBFL::FindPathToNearestGoal(Start, BlockedGoals, Grid, NodeSize, GoalIndex, Stats);
+	TestEqual(TEXT("No path to blocked goals"), Path.Num(), 0);
+	TestEqual(TEXT("No goal index without a path"), GoalIndex, static_cast<int32>(INDEX_NONE));
+
+	// 网格外的目标与单目标寻路一样视为可通行
+	const TArray<FVector> OutsideGoals = { CellCenter(FIntVector(9, 9, 0)), CellCenter(FIntVector(-1, 0, 0)) };
+	Path = UFlightNavigationBFL::FindPathToNearestGoal(Start, OutsideGoals, Grid, NodeSize, GoalIndex, Stats);
+	TestEqual(TEXT("Goal just outside the grid is reachable"), GoalIndex, 1);
+	TestEqual(TEXT("Path to the outside goal"), Path.Num(), 2);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavMultiGoalRandomTest, "FlightNavigation.MultiGoal.MatchesPerGoalSearch",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavMultiGoalRandomTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	// 固定种子的随机障碍网格，目标数超过旧实现退化为 Dijkstra 的 32 个
+	FRandomStream Random(7331);
+	const FIntVector Dimensions(12, 12, 3);
+	TMap<FVector, FAStarNode> Grid = MakeGrid(Dimensions);
+	for (TPair<FVector, FAStarNode>& Voxel : Grid)
+	{
+		Voxel.Value.bIsWalkable = Random.FRand() > 0.25f;
+	}
+
+	FFlightNavLandmarks Landmarks;
+	Landmarks.Build(Grid, NodeSize, 4);
+
+	auto RandomCell = [&Random, &Dimensions]()
+	{
+		return CellCenter(FIntVector(Random.RandHelper(Dimensions.X), Random.RandHelper(Dimensions.Y), Random.RandHelper(Dimensions.Z)));
+	};
+
+	for (int32 Query = 0; Query < 20; ++Query)
+	{
+		// 起点格子本身不需要可通行
+		const FVector Start = RandomCell();
+
+		TArray<FVector> Goals;
+		const int32 NumGoals = Query % 2 == 0 ? 3 : 40;
+		for (int32 Index = 0; Index < NumGoals; ++Index)
+		{
+			Goals.Add(RandomCell());
+		}
+
+		const float Expected = FlightNavMultiGoalTests::NearestByEnumeration(Start, Goals, Grid);
+
+		int32 GoalIndex = INDEX_NONE;
+		FFlightNavQueryStats Stats;
+		const TArray<FVector> Path = UFlightNavigationBFL::FindPathToNearestGoal(Start, Goals, Grid, NodeSize, GoalIndex, Stats);
+		int32 LandmarkGoalIndex = INDEX_NONE;
+		FFlightNavQueryStats LandmarkStats;
+		const TArray<FVector> LandmarkPath = UFlightNavigationBFL::FindPathToNearestGoal(Start, Goals, Grid, NodeSize, LandmarkGoalIndex, LandmarkStats, &Landmarks);
+
+		if (Expected < 0.0f)
+		{
+			TestEqual(FString::Printf(TEXT("Query %d has no reachable goal"), Query), Path.Num(), 0);
+			TestEqual(FString::Printf(TEXT("Query %d has no reachable goal with landmarks"), Query), LandmarkPath.Num(), 0);
+			continue;
+		}
+
+		TestNearlyEqual(FString::Printf(TEXT("Query %d nearest goal cost"), Query), PathLength(Path), Expected, LengthTolerance);
+		TestNearlyEqual(FString::Printf(TEXT("Query %d nearest goal cost with landmarks"), Query), PathLength(LandmarkPath), Expected, LengthTolerance);
+		if (TestTrue(FString::Printf(TEXT("Query %d goal index"), Query), Goals.IsValidIndex(GoalIndex)) && Path.Num() > 0)
+		{
+			TestEqual(FString::Printf(TEXT("Query %d path ends at the reported goal"), Query),
+				Path.Last(), UFlightNavigationBFL::GetGridCenter(Goals[GoalIndex], NodeSize));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavMultiGoalLandmarkBoundTest, "FlightNavigation.MultiGoal.LandmarkBoundIsAdmissible",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavMultiGoalLandmarkBoundTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	// 与 PicksNearestByPathCost 相同的墙
+	const TMap<FVector, FAStarNode> Grid = MakeWallGrid(FIntVector(10, 10, 1), 2, 9);
+	FFlightNavLandmarks Landmarks;
+	Landmarks.Build(Grid, NodeSize, 4);
+
+	const TArray<FIntVector> Cells = {
+		FIntVector(0, 0, 0), FIntVector(1, 8, 0), FIntVector(2, 9, 0), FIntVector(3, 0, 0), FIntVector(5, 5, 0),
+		FIntVector(9, 0, 0), FIntVector(9, 9, 0), FIntVector(0, 9, 0), FIntVector(6, 2, 0), FIntVector(1, 3, 0)
+	};
+	const TArray<FVector> Goals = { CellCenter(FIntVector(4, 0, 0)), CellCenter(FIntVector(8, 6, 0)), CellCenter(FIntVector(0, 7, 0)) };
+
+	TArray<float> MinGoalDistances;
+	TArray<float> MaxGoalDistances;
+	if (!TestTrue(TEXT("Goal set is in the distance table"), Landmarks.PrepareGoalSet(Goals, MinGoalDistances, MaxGoalDistances)))
+	{
+		return false;
+	}
+
+	for (const FIntVector& Cell : Cells)
+	{
+		float NearestDistance = TNumericLimits<float>::Max();
+		for (const FVector& Goal : Goals)
+		{
+			FFlightNavQueryStats Stats;
+			NearestDistance = FMath::Min(NearestDistance, PathLength(UFlightNavigationBFL::FindPathWithStats(CellCenter(Cell), Goal, Grid, NodeSize, Stats)));
+		}
+
+		const float Bound = Landmarks.GetLowerBoundToSet(CellCenter(Cell), MinGoalDistances, MaxGoalDistances);
+		TestTrue(FString::Printf(TEXT("Goal set bound at %s (%.2f) <= nearest goal distance (%.2f)"), *Cell.ToString(), Bound, NearestDistance),
+			Bound <= NearestDistance + LengthTolerance);
+	}
+
+	// 只有一个终点时与单终点下界相同
+	const FVector SingleGoal = CellCenter(FIntVector(9, 4, 0));
+	TArray<float> GoalDistances;
+	Landmarks.PrepareGoal(SingleGoal, GoalDistances);
+	Landmarks.PrepareGoalSet(MakeArrayView(&SingleGoal, 1), MinGoalDistances, MaxGoalDistances);
+	for (const FIntVector& Cell : Cells)
+	{
+		TestNearlyEqual(FString::Printf(TEXT("Single goal set bound at %s"), *Cell.ToString()),
+			Landmarks.GetLowerBoundToSet(CellCenter(Cell), MinGoalDistances, MaxGoalDistances),
+			Landmarks.GetLowerBound(CellCenter(Cell), GoalDistances), KINDA_SMALL_NUMBER);
+	}
+
+	// 网格外的终点不在表中，不能给出下界
+	const FVector OutsideGoal = CellCenter(FIntVector(20, 0, 0));
+	TestFalse(TEXT("Goal outside the grid has no landmark bound"), Landmarks.PrepareGoalSet(MakeArrayView(&OutsideGoal, 1), MinGoalDistances, MaxGoalDistances));
+	return true;
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestWorld.h"
+#include "FlightNavPathIndex.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavPathIndexTests
+{
+	// 记录一条订阅收到的失效通知
+	struct FListener
+	{
+		int32 NumCalls = 0;
+		FFlightNavPathInvalidation Last;
+
+		FOnFlightNavPathInvalidatedNative MakeDelegate()
+		{
+			return FOnFlightNavPathInvalidatedNative::CreateLambda([this](const FFlightNavPathInvalidation& Invalidation)
+			{
+				++NumCalls;
+				Last = Invalidation;
+			});
+		}
+	};
+
+	// 把 Cells 标记为不可通行后通知索引，与 UpdateVoxelsInObstructionBox 的调用方式一致
+	static void CloseCells(FFlightNavPathIndex& PathIndex, uint32 GridId, TConstArrayView<FIntVector> Cells)
+	{
+		TMap<int32, FFlightNavPathInvalidation> Affected;
+		PathIndex.CollectAffected(GridId, Cells, Affected);
+		PathIndex.Invalidate(Affected);
+	}
+
+	static TArray<FVector> StraightPath(int32 Length)
+	{
+		TArray<FVector> Path;
+		for (int32 X = 0; X < Length; ++X)
+		{
+			Path.Add(FlightNavTest::CellCenter(FIntVector(X, 0, 0)));
+		}
+		return Path;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavPathIndexCloseReopenTest, "FlightNavigation.PathIndex.CloseThenReopen",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavPathIndexCloseReopenTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavPathIndexTests;
+
+	static constexpr uint32 GridId = 1;
+	static constexpr uint32 OtherGridId = 2;
+	const TArray<FVector> Path = StraightPath(6);
+	const TArray<FIntVector> Wall = { FIntVector(3, 0, 0), FIntVector(3, 1, 0) };
+
+	FFlightNavPathIndex PathIndex;
+	FListener Listener;
+	FListener OtherGridListener;
+	const int32 FirstId = PathIndex.Subscribe(GridId, FlightNavTest::NodeSize, Path, Listener.MakeDelegate());
+	PathIndex.Subscribe(OtherGridId, FlightNavTest::NodeSize, Path, OtherGridListener.MakeDelegate());
+
+	CloseCells(PathIndex, GridId, Wall);
+	TestEqual(TEXT("Closing notifies the path once"), Listener.NumCalls, 1);
+	TestEqual(TEXT("Notification carries the subscription"), Listener.Last.SubscriptionId, FirstId);
+	TestEqual(TEXT("First invalid point"), Listener.Last.FirstInvalidIndex, 3);
+	TestEqual(TEXT("Invalid point count"), Listener.Last.NumInvalidPoints, 1);
+	TestEqual(TEXT("Paths on other grids are not notified"), OtherGridListener.NumCalls, 0);
+	TestEqual(TEXT("Invalidated subscription is removed"), PathIndex.Num(), 1);
+
+	// 订阅已移除，再次关闭不会重复通知
+	CloseCells(PathIndex, GridId, Wall);
+	TestEqual(TEXT("Removed subscription is not notified again"), Listener.NumCalls, 1);
+
+	// 重新打开后按新路径重新订阅，再次关闭时通知新的订阅
+	const int32 SecondId = PathIndex.Subscribe(GridId, FlightNavTest::NodeSize, Path, Listener.MakeDelegate());
+	TestNotEqual(TEXT("Resubscribing returns a new id"), SecondId, FirstId);
+	CloseCells(PathIndex, GridId, Wall);
+	TestEqual(TEXT("Closing after reopen notifies again"), Listener.NumCalls, 2);
+	TestEqual(TEXT("Notification carries the new subscription"), Listener.Last.SubscriptionId, SecondId);
+
+	// 退订后的路径不再收到通知；重新烘焙通知网格上剩下的路径
+	const int32 ThirdId = PathIndex.Subscribe(GridId, FlightNavTest::NodeSize, Path, Listener.MakeDelegate());
+	PathIndex.Unsubscribe(ThirdId);
+	CloseCells(PathIndex, GridId, Wall);
+	TestEqual(TEXT("Unsubscribed path is not notified"), Listener.NumCalls, 2);
+	PathIndex.InvalidateGrid(OtherGridId);
+	TestEqual(TEXT("Rebake notifies the other grid"), OtherGridListener.NumCalls, 1);
+	TestEqual(TEXT("Index is empty"), PathIndex.Num(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavPathIndexBanBoxTest, "FlightNavigation.PathIndex.BanBoxCloseThenReopen",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavPathIndexBanBoxTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+	using namespace FlightNavPathIndexTests;
+
+	// 10 x 10 的平面网格，禁飞盒挡住 X = 4、5 两列，只在 Y = 9 留缺口
+	FTestWorld TestWorld(FBox(FVector(0.0), FVector(1000.0, 1000.0, 100.0)));
+	ABanFlightNavMeshBoundsVolume* BanBox = TestWorld.AddBanBox(FBox(FVector(400.0, 0.0, 0.0), FVector(600.0, 900.0, 100.0)));
+	UOctreeFlightComponent& Component = TestWorld.GetComponent();
+	Component.InitializeGenerateFlightNavMesh();
+	Component.Start = CellCenter(FIntVector(0, 0, 0));
+	Component.Goal = CellCenter(FIntVector(9, 0, 0));
+	FFlightNavPathIndex& PathIndex = TestWorld.GetPathIndex();
+
+	// 打开禁飞盒后直线穿过
+	TestWorld.SetBanBoxOpen(BanBox, true);
+	FListener Listener;
+	PathIndex.Subscribe(Component.GetUniqueID(), NodeSize, Component.FindFlightPath(), Listener.MakeDelegate());
+
+	TestWorld.SetBanBoxOpen(BanBox, false);
+	TestEqual(TEXT("Closing the ban box notifies the path"), Listener.NumCalls, 1);
+	TestEqual(TEXT("Path breaks at the first banned column"), Listener.Last.FirstInvalidIndex, 4);
+
+	// 重新打开不会让路径失效；按新路径重新订阅后再次关闭会再次通知
+	TestWorld.SetBanBoxOpen(BanBox, true);
+	TestEqual(TEXT("Reopening does not notify"), Listener.NumCalls, 1);
+	PathIndex.Subscribe(Component.GetUniqueID(), NodeSize, Component.FindFlightPath(), Listener.MakeDelegate());
+	TestWorld.SetBanBoxOpen(BanBox, false);
+	TestEqual(TEXT("Closing after reopen notifies again"), Listener.NumCalls, 2);
+	return true;
+}
+
+#endif
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestGrid.h"
+#include "FlightNavRaycast.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavRaycastTests
+{
+	// 参照实现：对每个阻挡格子做线段-盒体 slab 相交，取进入参数最小者；没有阻挡时返回 false
+	static bool BruteForceTrace(const TMap<FVector, FAStarNode>& Grid, const FVector& Start, const FVector& End, FVector& OutCellCenter, double& OutEntryT)
+	{
+		const FVector Delta = End - Start;
+		OutEntryT = TNumericLimits<double>::Max();
+		for (const TPair<FVector, FAStarNode>& Voxel : Grid)
+		{
+			if (Voxel.Value.bIsWalkable)
+			{
+				continue;
+			}
+
+			const FVector BoxMin = Voxel.Key - FVector(FlightNavTest::NodeSize * 0.5f);
+			const FVector BoxMax = Voxel.Key + FVector(FlightNavTest::NodeSize * 0.5f);
+			double TEnter = 0.0;
+			double TExit = 1.0;
+			bool bSeparated = false;
+			for (int32 Axis = 0; Axis < 3 && !bSeparated; ++Axis)
+			{
+				if (FMath::IsNearlyZero(Delta[Axis]))
+				{
+					bSeparated = Start[Axis] < BoxMin[Axis] || Start[Axis] > BoxMax[Axis];
+					continue;
+				}
+				const double T1 = (BoxMin[Axis] - Start[Axis]) / Delta[Axis];
+				const double T2 = (BoxMax[Axis] - Start[Axis]) / Delta[Axis];
+				TEnter = FMath::Max(TEnter, FMath::Min(T1, T2));
+				TExit = FMath::Min(TExit, FMath::Max(T1, T2));
+				bSeparated = TEnter > TExit;
+			}
+
+			if (!bSeparated && TEnter < OutEntryT)
+			{
+				OutEntryT = TEnter;
+				OutCellCenter = Voxel.Key;
+			}
+		}
+		return OutEntryT <= 1.0;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavRaycastCorridorTest, "FlightNavigation.Raycast.Corridor",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavRaycastCorridorTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	TMap<FVector, FAStarNode> Grid = MakeGrid(FIntVector(8, 1, 1));
+	const FVector Start = CellCenter(FIntVector(0, 0, 0));
+
+	FFlightNavRayHit Hit;
+	TestFalse(TEXT("Open corridor has line of sight"), FFlightNavRaycast::Trace(Grid, NodeSize, Start, CellCenter(FIntVector(7, 0, 0)), false, Hit));
+	TestNearlyEqual(TEXT("Unblocked distance is the segment length"), Hit.Distance, 700.0f, LengthTolerance);
+	TestEqual(TEXT("Unblocked location is the end point"), Hit.Location, CellCenter(FIntVector(7, 0, 0)));
+
+	SetWalkable(Grid, FIntVector(4, 0, 0), false);
+	TestTrue(TEXT("Blocked cell stops the ray"), FFlightNavRaycast::Trace(Grid, NodeSize, Start, CellCenter(FIntVector(7, 0, 0)), false, Hit));
+	TestEqual(TEXT("Hit cell"), Hit.CellCenter, CellCenter(FIntVector(4, 0, 0)));
+	TestNearlyEqual(TEXT("Hit location is the entry face"), Hit.Location.X, 400.0, 0.01);
+	TestNearlyEqual(TEXT("Hit distance"), Hit.Distance, 350.0f, LengthTolerance);
+
+	TestFalse(TEXT("Segment ending before the blocked cell is clear"), FFlightNavRaycast::Trace(Grid, NodeSize, Start, CellCenter(FIntVector(3, 0, 0)), false, Hit));
+
+	// 离开网格：缺失的格子按参数决定是否阻挡
+	SetWalkable(Grid, FIntVector(4, 0, 0), true);
+	const FVector Outside = CellCenter(FIntVector(9, 0, 0));
+	TestFalse(TEXT("Missing cells pass by default"), FFlightNavRaycast::Trace(Grid, NodeSize, Start, Outside, false, Hit));
+	TestTrue(TEXT("Missing cells block when requested"), FFlightNavRaycast::Trace(Grid, NodeSize, Start, Outside, true, Hit));
+	TestNearlyEqual(TEXT("Missing cell hit at the grid boundary"), Hit.Location.X, 800.0, 0.01);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavRaycastRandomTest, "FlightNavigation.Raycast.MatchesBruteForce",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavRaycastRandomTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	// 固定种子：随机阻挡的 8 x 8 x 4 网格与随机线段，端点几乎不可能恰好经过格子棱角
+	FRandomStream Random(20240611);
+	TMap<FVector, FAStarNode> Grid = MakeGrid(FIntVector(8, 8, 4));
+	for (TPair<FVector, FAStarNode>& Voxel : Grid)
+	{
+		Voxel.Value.bIsWalkable = Random.FRand() > 0.15f;
+	}
+
+	const FBox GridBox(FVector::ZeroVector, FVector(8, 8, 4) * NodeSize);
+	TArray<FFlightNavRaySegment> Segments;
+	for (int32 Index = 0; Index < 3 * FFlightNavRaycast::SegmentsPerTask; ++Index)
+	{
+		FFlightNavRaySegment& Segment = Segments.AddDefaulted_GetRef();
+		Segment.Start = Random.RandPointInBox(GridBox);
+		Segment.End = Random.RandPointInBox(GridBox);
+	}
+
+	TArray<FFlightNavRayHit> BatchHits;
+	FFlightNavRaycast::TraceBatch(Grid, NodeSize, Segments, false, BatchHits);
+	TArray<bool> Visible;
+	FFlightNavRaycast::LineOfSightBatch(Grid, NodeSize, Segments, false, Visible);
+
+	for (int32 Index = 0; Index < Segments.Num(); ++Index)
+	{
+		const FFlightNavRaySegment& Segment = Segments[Index];
+		FVector ExpectedCell;
+		double ExpectedT = 0.0;
+		const bool bExpectedHit = FlightNavRaycastTests::BruteForceTrace(Grid, Segment.Start, Segment.End, ExpectedCell, ExpectedT);
+
+		FFlightNavRayHit Hit;
+		const bool bHit = FFlightNavRaycast::Trace(Grid, NodeSize, Segment.Start, Segment.End, false, Hit);
+		if (!TestEqual(FString::Printf(TEXT("Segment %d blocked"), Index), bHit, bExpectedHit))
+		{
+			continue;
+		}
+		TestEqual(FString::Printf(TEXT("Segment %d batch result"), Index), BatchHits[Index].bBlockingHit, bHit);
+		TestEqual(FString::Printf(TEXT("Segment %d line of sight"), Index), Visible[Index], !bHit);
+		if (bHit)
+		{
+			TestEqual(FString::Printf(TEXT("Segment %d first blocked cell"), Index), Hit.CellCenter, ExpectedCell);
+			TestNearlyEqual(FString::Printf(TEXT("Segment %d hit distance"), Index), Hit.Distance,
+				static_cast<float>(ExpectedT * FVector::Dist(Segment.Start, Segment.End)), LengthTolerance);
+			TestEqual(FString::Printf(TEXT("Segment %d batch hit cell"), Index), BatchHits[Index].CellCenter, Hit.CellCenter);
+		}
+	}
+	return true;
+}
+
+#endif
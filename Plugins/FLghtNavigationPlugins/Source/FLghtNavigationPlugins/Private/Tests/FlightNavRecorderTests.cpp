@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestWorld.h"
+#include "FlightNavRecorder.h"
+#include "FlightNavReplayer.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavRecorderLateStartTest, "FlightNavigation.Recorder.LateStartRoundTrip",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavRecorderLateStartTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavTest;
+
+	if (FFlightNavRecorder::IsRecording())
+	{
+		AddWarning(TEXT("A FlightNav recording is already running, skipped."));
+		return true;
+	}
+
+	// 10 x 10 的平面网格，X = 4、5 两列被禁飞盒挡住，只在 Y = 9 留缺口
+	FTestWorld TestWorld(FBox(FVector(0.0), FVector(1000.0, 1000.0, 100.0)));
+	ABanFlightNavMeshBoundsVolume* BanBox = TestWorld.AddBanBox(FBox(FVector(400.0, 0.0, 0.0), FVector(600.0, 900.0, 100.0)));
+	UOctreeFlightComponent& Component = TestWorld.GetComponent();
+	Component.NumLandmarks = 4;
+	Component.InitializeGenerateFlightNavMesh();
+	Component.Start = CellCenter(FIntVector(0, 0, 0));
+	Component.Goal = CellCenter(FIntVector(9, 0, 0));
+
+	// 烘焙时禁飞盒已关闭，录制从之后才开始
+	const FString LogFile = FPaths::AutomationTransientDir() / TEXT("FlightNavRecorderLateStart.fnrec");
+	if (!TestTrue(TEXT("Recording starts"), FFlightNavRecorder::Get().Start(LogFile)))
+	{
+		return false;
+	}
+	const TArray<FVector> AroundPath = Component.FindFlightPath();
+	TestWorld.SetBanBoxOpen(BanBox, true);
+	const TArray<FVector> ThroughPath = Component.FindFlightPath();
+	TestWorld.SetBanBoxOpen(BanBox, false);
+	Component.FindFlightPath();
+	FFlightNavRecorder::Get().Stop();
+
+	TestTrue(TEXT("Opening the ban box shortens the path"), PathLength(ThroughPath) + LengthTolerance < PathLength(AroundPath));
+
+	const int64 RecordedQueries = FFlightNavMetrics::Get().GetSummary(EFlightNavMetric::FindPath).TotalCount;
+
+	FString Error;
+	FFlightNavReplayer Replayer;
+	TArray<FFlightNavReplayQueryResult> Results;
+	if (!TestTrue(TEXT("Recording loads"), Replayer.Load(LogFile, Error)) ||
+		!TestTrue(TEXT("Recording replays"), Replayer.Run(2, Results, Error)))
+	{
+		AddError(Error);
+		return false;
+	}
+
+	TestEqual(TEXT("Replayed query count"), Results.Num(), 3);
+	for (const FFlightNavReplayQueryResult& Result : Results)
+	{
+		TestTrue(FString::Printf(TEXT("Query %d is replayed"), Result.QueryIndex), Result.bReplayed);
+		TestFalse(FString::Printf(TEXT("Query %d matches the recorded path"), Result.QueryIndex), Result.IsMismatch());
+	}
+	TestEqual(TEXT("Replay does not feed the runtime metrics"),
+		FFlightNavMetrics::Get().GetSummary(EFlightNavMetric::FindPath).TotalCount, RecordedQueries);
+	return true;
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavNeighborKernel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// 自动化测试用的小型合成网格，格子坐标与 FlightNavNeighborKernel 的换算一致
+namespace FlightNavTest
+{
+	static constexpr float NodeSize = 100.0f;
+
+	inline FVector CellCenter(const FIntVector& Cell)
+	{
+		return FlightNavNeighborKernel::ToCenter(Cell, NodeSize);
+	}
+
+	// 格子 (0,0,0) 到 Dimensions - 1 全部可通行，按 X、Y、Z 顺序插入（与烘焙一致）
+	inline TMap<FVector, FAStarNode> MakeGrid(const FIntVector& Dimensions)
+	{
+		TMap<FVector, FAStarNode> Grid;
+		for (int32 X = 0; X < Dimensions.X; ++X)
+		{
+			for (int32 Y = 0; Y < Dimensions.Y; ++Y)
+			{
+				for (int32 Z = 0; Z < Dimensions.Z; ++Z)
+				{
+					const FVector Center = CellCenter(FIntVector(X, Y, Z));
+					Grid.Add(Center, FAStarNode(Center, NodeSize, true));
+				}
+			}
+		}
+		return Grid;
+	}
+
+	inline void SetWalkable(TMap<FVector, FAStarNode>& Grid, const FIntVector& Cell, bool bIsWalkable)
+	{
+		Grid.FindChecked(CellCenter(Cell)).bIsWalkable = bIsWalkable;
+	}
+
+	// 在 MakeGrid 的网格中 X = WallX 处立一堵墙，只在 Y = GapY 留缺口（所有 Z 层相同）
+	inline TMap<FVector, FAStarNode> MakeWallGrid(const FIntVector& Dimensions, int32 WallX, int32 GapY)
+	{
+		TMap<FVector, FAStarNode> Grid = MakeGrid(Dimensions);
+		for (int32 Y = 0; Y < Dimensions.Y; ++Y)
+		{
+			for (int32 Z = 0; Z < Dimensions.Z && Y != GapY; ++Z)
+			{
+				SetWalkable(Grid, FIntVector(WallX, Y, Z), false);
+			}
+		}
+		return Grid;
+	}
+
+	inline float PathLength(const TArray<FVector>& Path)
+	{
+		float Length = 0.0f;
+		for (int32 Index = 1; Index < Path.Num(); ++Index)
+		{
+			Length += FVector::Dist(Path[Index - 1], Path[Index]);
+		}
+		return Length;
+	}
+
+	// 搜索中 g 按单精度逐步累加，比较路径长度时允许的误差
+	static constexpr float LengthTolerance = 0.1f;
+}
+
+#endif
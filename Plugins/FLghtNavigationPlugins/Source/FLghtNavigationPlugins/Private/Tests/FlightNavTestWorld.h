@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FlightNavTestGrid.h"
+#include "FlightNavWorldSubsystem.h"
+#include "OctreeFlightComponent.h"
+#include "Components/BrushComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "PhysicsEngine/BodySetup.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavTest
+{
+	/**
+	 * 自动化测试用的临时 World
+	 *
+	 * 包含一个导航范围体积和挂着 UOctreeFlightComponent 的 Actor，组件用几何光栅化烘焙（场景中没有碰撞体，
+	 * 烘焙结果全部可通行），禁飞盒通过 AddBanBox 添加。析构时销毁 World。
+	 */
+	class FTestWorld
+	{
+	public:
+		explicit FTestWorld(const FBox& NavBounds)
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+
+			AActor* Owner = World->SpawnActor<AActor>();
+			Component = NewObject<UOctreeFlightComponent>(Owner);
+			Component->NodeSize = NodeSize;
+			Component->Voxelizer = EFlightNavVoxelizer::GeometryRasterization;
+			Component->FlightNavMeshBoundsVolume = SpawnVolume<AFlightNavMeshBoundsVolume>(NavBounds);
+			Component->RegisterComponent();
+		}
+
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		UOctreeFlightComponent& GetComponent() const { return *Component; }
+
+		FFlightNavPathIndex& GetPathIndex() const { return World->GetSubsystem<UFlightNavWorldSubsystem>()->GetPathIndex(); }
+
+		// 在下一次烘焙时生效
+		ABanFlightNavMeshBoundsVolume* AddBanBox(const FBox& Box)
+		{
+			ABanFlightNavMeshBoundsVolume* BanBox = SpawnVolume<ABanFlightNavMeshBoundsVolume>(Box);
+			Component->BanFlightNavMeshBoundsVolumes.Add(BanBox);
+			return BanBox;
+		}
+
+		// bOpen 为 true 时禁飞盒内的格子恢复为可通行
+		void SetBanBoxOpen(ABanFlightNavMeshBoundsVolume* BanBox, bool bOpen) const
+		{
+			FVector Center = BanBox->GetBounds().GetBox().GetCenter();
+			Component->UpdateVoxelsInObstructionBox(Center, bOpen);
+		}
+
+	private:
+		// 没有画刷模型时，UBrushComponent 用 BrushBodySetup 的碰撞计算包围盒
+		template <typename VolumeType>
+		VolumeType* SpawnVolume(const FBox& Box) const
+		{
+			VolumeType* Volume = World->SpawnActor<VolumeType>(Box.GetCenter(), FRotator::ZeroRotator);
+			UBrushComponent* Brush = Volume->GetBrushComponent();
+			Brush->BrushBodySetup = NewObject<UBodySetup>(Brush);
+			const FVector Size = Box.GetSize();
+			Brush->BrushBodySetup->AggGeom.BoxElems.Add(FKBoxElem(Size.X, Size.Y, Size.Z));
+			return Volume;
+		}
+
+		UWorld* World = nullptr;
+		UOctreeFlightComponent* Component = nullptr;
+	};
+}
+
+#endif
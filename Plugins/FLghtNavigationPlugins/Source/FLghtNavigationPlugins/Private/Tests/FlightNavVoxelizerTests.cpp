@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlightNavTestGrid.h"
+#include "FlightNavVoxelizer.h"
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FlightNavVoxelizerTests
+{
+	// [-400, 400]^3 的 8 x 8 x 8 网格，体素 100
+	static const FVector MinBounds(-400.0);
+	static const FVector MaxBounds(400.0);
+
+	// 未注册到 World 的碰撞体，与 commandlet 中读取到的组件状态一致
+	template <typename ComponentType>
+	static ComponentType* NewBlockingShape(const FTransform& Transform)
+	{
+		ComponentType* Component = NewObject<ComponentType>(GetTransientPackage());
+		Component->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Component->SetWorldTransform(Transform);
+		return Component;
+	}
+
+	static TMap<FVector, FAStarNode> Rasterize(UPrimitiveComponent* Component)
+	{
+		FFlightNavVoxelizer Voxelizer(MinBounds, MaxBounds, FlightNavTest::NodeSize);
+		Voxelizer.AddComponent(Component);
+		TMap<FVector, FAStarNode> Grid;
+		Voxelizer.Rasterize(Grid);
+		return Grid;
+	}
+
+	static bool IsBlocked(const TMap<FVector, FAStarNode>& Grid, const FVector& Center)
+	{
+		return !Grid.FindChecked(Center).bIsWalkable;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavVoxelizerShapesTest, "FlightNavigation.Voxelizer.SimpleShapes",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavVoxelizerShapesTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavVoxelizerTests;
+
+	USphereComponent* Sphere = NewBlockingShape<USphereComponent>(FTransform::Identity);
+	Sphere->SetSphereRadius(150.0f, false);
+	const TMap<FVector, FAStarNode> SphereGrid = Rasterize(Sphere);
+	TestEqual(TEXT("Sphere grid size"), SphereGrid.Num(), 512);
+	TestTrue(TEXT("Sphere blocks the cell at its center"), IsBlocked(SphereGrid, FVector(50.0, 50.0, 50.0)));
+	// 格子最近点 (100, 100, 0) 距球心 141
+	TestTrue(TEXT("Sphere blocks a cell it reaches diagonally"), IsBlocked(SphereGrid, FVector(150.0, 150.0, 50.0)));
+	// 格子最近点 (100, 100, 100) 距球心 173
+	TestFalse(TEXT("Sphere leaves the corner cell open"), IsBlocked(SphereGrid, FVector(150.0, 150.0, 150.0)));
+	TestFalse(TEXT("Sphere leaves distant cells open"), IsBlocked(SphereGrid, FVector(250.0, 50.0, 50.0)));
+
+	UBoxComponent* Box = NewBlockingShape<UBoxComponent>(FTransform::Identity);
+	Box->SetBoxExtent(FVector(120.0), false);
+	const TMap<FVector, FAStarNode> BoxGrid = Rasterize(Box);
+	TestTrue(TEXT("Box blocks inner cells"), IsBlocked(BoxGrid, FVector(-50.0, 50.0, -50.0)));
+	TestTrue(TEXT("Box blocks partially covered cells"), IsBlocked(BoxGrid, FVector(150.0, -150.0, 150.0)));
+	TestFalse(TEXT("Box leaves outside cells open"), IsBlocked(BoxGrid, FVector(250.0, 50.0, 50.0)));
+
+	// 半径 80、轴线 z 在 [-220, 220] 的竖直胶囊体
+	UCapsuleComponent* Capsule = NewBlockingShape<UCapsuleComponent>(FTransform::Identity);
+	Capsule->SetCapsuleSize(80.0f, 300.0f, false);
+	const TMap<FVector, FAStarNode> CapsuleGrid = Rasterize(Capsule);
+	TestTrue(TEXT("Capsule blocks cells on its axis"), IsBlocked(CapsuleGrid, FVector(50.0, 50.0, 50.0)));
+	TestTrue(TEXT("Capsule blocks cells around its top cap"), IsBlocked(CapsuleGrid, FVector(-50.0, 50.0, 250.0)));
+	// 格子到轴线 100 > 80；按格子中心加半对角线估计时会被误标（158 < 80 + 86.6）
+	TestFalse(TEXT("Capsule leaves the adjacent column open"), IsBlocked(CapsuleGrid, FVector(150.0, 50.0, 50.0)));
+	TestFalse(TEXT("Capsule leaves the diagonal column open"), IsBlocked(CapsuleGrid, FVector(-150.0, -150.0, -50.0)));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavVoxelizerCapsuleTest, "FlightNavigation.Voxelizer.TiltedCapsuleMatchesSampling",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavVoxelizerCapsuleTest::RunTest(const FString& Parameters)
+{
+	using namespace FlightNavVoxelizerTests;
+
+	const FTransform Transform(FRotator(30.0, 45.0, 0.0), FVector(20.0, -35.0, 10.0));
+	constexpr float Radius = 90.0f;
+	constexpr float HalfHeight = 320.0f;
+	UCapsuleComponent* Capsule = NewBlockingShape<UCapsuleComponent>(Transform);
+	Capsule->SetCapsuleSize(Radius, HalfHeight, false);
+	const TMap<FVector, FAStarNode> Grid = Rasterize(Capsule);
+
+	const FVector A = Transform.TransformPosition(FVector(0.0, 0.0, HalfHeight - Radius));
+	const FVector B = Transform.TransformPosition(FVector(0.0, 0.0, Radius - HalfHeight));
+
+	// 在格子内 11^3 个点上采样到轴线的最小距离，采样误差不超过半个采样间距的对角线
+	constexpr int32 Samples = 11;
+	const double Spacing = FlightNavTest::NodeSize / (Samples - 1);
+	const double SampleError = FMath::Sqrt(3.0) * Spacing * 0.5;
+	int32 NumChecked = 0;
+	for (const TPair<FVector, FAStarNode>& Voxel : Grid)
+	{
+		const FVector CellMin = Voxel.Key - FVector(FlightNavTest::NodeSize * 0.5f);
+		double MinDistance = TNumericLimits<double>::Max();
+		for (int32 X = 0; X < Samples; ++X)
+		{
+			for (int32 Y = 0; Y < Samples; ++Y)
+			{
+				for (int32 Z = 0; Z < Samples; ++Z)
+				{
+					const FVector Point = CellMin + FVector(X, Y, Z) * Spacing;
+					MinDistance = FMath::Min(MinDistance, static_cast<double>(FMath::PointDistToSegment(Point, A, B)));
+				}
+			}
+		}
+
+		// 采样结果落在半径附近的格子无法判定，跳过
+		if (MinDistance < Radius)
+		{
+			TestFalse(FString::Printf(TEXT("Cell %s overlaps the capsule"), *Voxel.Key.ToString()), Voxel.Value.bIsWalkable);
+			++NumChecked;
+		}
+		else if (MinDistance - SampleError > Radius + 1.0)
+		{
+			TestTrue(FString::Printf(TEXT("Cell %s is clear of the capsule"), *Voxel.Key.ToString()), Voxel.Value.bIsWalkable);
+			++NumChecked;
+		}
+	}
+	TestTrue(TEXT("Most cells are decidable by sampling"), NumChecked > Grid.Num() * 9 / 10);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightNavVoxelizerGridLimitTest, "FlightNavigation.Voxelizer.RejectsOversizedGrid",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlightNavVoxelizerGridLimitTest::RunTest(const FString& Parameters)
+{
+	AddExpectedError(TEXT("exceed the grid limit"), EAutomationExpectedErrorFlags::Contains, 2);
+
+	// 每个方向 10^5 格，乘积超出 int32 但每个方向都不超出
+	TMap<FVector, FAStarNode> Grid;
+	const FFlightNavVoxelizer Cube(FVector::ZeroVector, FVector(1.0e7), FlightNavTest::NodeSize);
+	TestFalse(TEXT("Cube above the cell limit is rejected"), Cube.Rasterize(Grid));
+	TestEqual(TEXT("Rejected cube leaves the grid empty"), Grid.Num(), 0);
+
+	// 单个方向就超出 int32
+	const FFlightNavVoxelizer Line(FVector::ZeroVector, FVector(1.0e13, 100.0, 100.0), FlightNavTest::NodeSize);
+	TestFalse(TEXT("Line longer than int32 cells is rejected"), Line.Rasterize(Grid));
+	TestEqual(TEXT("Rejected line leaves the grid empty"), Grid.Num(), 0);
+	return true;
+}
+
+#endif
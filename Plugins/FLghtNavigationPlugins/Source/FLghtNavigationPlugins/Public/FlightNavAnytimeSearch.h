@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavStats.h"
+#include "FlightNavLandmarks.h"
+
+// Step 的返回结果
+enum class EFlightNavAnytimeStatus : uint8
+{
+	// 预算用完，搜索尚未结束
+	Searching,
+	// 本次得到了更优的路径（可能还会继续改进）
+	Improved,
+	// 已得到最优路径，搜索结束
+	Optimal,
+	// 无法到达终点，搜索结束
+	Failed
+};
+
+/**
+ * 可分帧执行的 Anytime 搜索（ARA*）
+ *
+ * 先用放大系数 Epsilon 的启发函数快速得到代价不超过最优解 Epsilon 倍的路径，
+ * 之后逐步减小 Epsilon 并复用已有的搜索结果继续改进，直到 Epsilon 为 1（最优）。
+ * 每次 Step 最多展开 ExpansionBudget 个节点，可以随时暂停并在下一帧继续。
+ *
+ * 搜索只读引用 GridNodes，网格发生变化后需要重新 Begin。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavAnytimeSearch
+{
+public:
+	// Landmarks 可为空；非空时启发函数取欧几里得距离与 ALT 下界的较大者
+	FFlightNavAnytimeSearch(const TMap<FVector, FAStarNode>& InGridNodes, float InNodeSize, const FFlightNavLandmarks* InLandmarks = nullptr);
+
+	// 开始新的搜索（会丢弃之前的状态）
+	void Begin(const FVector& Start, const FVector& Goal, float InitialEpsilon, float EpsilonStep);
+
+	// 在预算内推进搜索
+	EFlightNavAnytimeStatus Step(int32 ExpansionBudget);
+
+	// 目前找到的最好路径
+	const TArray<FVector>& GetBestPath() const { return BestPath; }
+
+	// 最好路径的次优上界：路径代价 <= 上界 * 最优代价
+	float GetSuboptimalityBound() const { return SuboptimalityBound; }
+
+	bool IsFinished() const { return bFinished; }
+
+	// 所有 Step 累计的统计
+	const FFlightNavQueryStats& GetStats() const { return Stats; }
+
+private:
+	struct FNodeRecord
+	{
+		float G = TNumericLimits<float>::Max();
+		float H = 0.0f;
+		FVector Parent = FVector::ZeroVector;
+		bool bHasParent = false;
+		bool bInOpen = false;
+		bool bInIncons = false;
+		// 在第几轮 ImprovePath 中被关闭（0 表示从未关闭）
+		uint32 ClosedIteration = 0;
+	};
+
+	struct FOpenEntry
+	{
+		FVector Cell;
+		float Key;
+
+		bool operator<(const FOpenEntry& Other) const { return Key < Other.Key; }
+	};
+
+	FNodeRecord& FindOrAddRecord(const FVector& Cell);
+	float GetKey(const FNodeRecord& Record) const { return Record.G + Epsilon * Record.H; }
+	bool IsPassable(const FVector& Cell) const;
+	void PushOpen(const FVector& Cell, FNodeRecord& Record);
+	float GetMinOpenKey();
+
+	EFlightNavAnytimeStatus StepInternal(int32 ExpansionBudget);
+
+	// 当前 Epsilon 的解已找到：发布路径并进入下一轮
+	EFlightNavAnytimeStatus PublishAndAdvance();
+	void RetraceBestPath();
+
+	const TMap<FVector, FAStarNode>& GridNodes;
+	float NodeSize;
+	const FFlightNavLandmarks* Landmarks;
+	TArray<float> GoalLandmarkDistances;
+
+	FVector StartCell = FVector::ZeroVector;
+	FVector GoalCell = FVector::ZeroVector;
+	FIntVector GoalIndex = FIntVector::ZeroValue;
+	float Epsilon = 1.0f;
+	float EpsilonDecrease = 0.5f;
+	uint32 Iteration = 1;
+
+	// 已访问节点；OPEN / INCONS 集合用记录上的标记表示
+	TMap<FVector, FNodeRecord> Records;
+	// 懒删除的二叉堆：过期的条目在出堆时丢弃
+	TArray<FOpenEntry> OpenHeap;
+
+	TArray<FVector> BestPath;
+	float SuboptimalityBound = TNumericLimits<float>::Max();
+	bool bFinished = true;
+
+	FFlightNavQueryStats Stats;
+};
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "FlightNavBakeCommandlet.generated.h"
+
+/**
+ * 无界面烘焙体素网格
+ *
+ * UnrealEditor-Cmd <项目> -run=FlightNavBake -Map=<关卡包路径> [-OutDir=<输出目录>]
+ * 加载关卡（不创建物理场景），对其中每个 UOctreeFlightComponent 用碰撞几何光栅化烘焙，
+ * 网格写成 .fnsnap 快照（格式见 FlightNavRecording::FGridSnapshot），默认输出到 Saved/FlightNav。
+ * 全部烘焙成功返回 0。
+ */
+UCLASS()
+class FLGHTNAVIGATIONPLUGINS_API UFlightNavBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UFlightNavBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
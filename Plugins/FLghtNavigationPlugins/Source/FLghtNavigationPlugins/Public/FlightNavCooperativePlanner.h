@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavReservationTable.h"
+#include "FlightNavStats.h"
+
+// 一次协同寻路的参数
+struct FFlightNavCooperativeRequest
+{
+	FVector Start = FVector::ZeroVector;
+	FVector Goal = FVector::ZeroVector;
+	// 路径第一个点对应的时间片
+	int32 StartTimeSlot = 0;
+	// 考虑其他智能体预约的时间片数
+	int32 Window = 16;
+	// 发起请求的智能体，不能为 FFlightNavReservationTable::NoAgent
+	uint32 AgentId = FFlightNavReservationTable::NoAgent;
+};
+
+/**
+ * 窗口化分层协同 A*（WHCA*）
+ *
+ * 在 (格子, 时间片) 空间中搜索，只在前 Window 个时间片内避开预约表里其他智能体已提交的路线，
+ * 窗口内允许原地等待；窗口外的剩余距离由一个从终点反向、按需续算的空间 A*（RRA*）精确给出，
+ * 同时作为启发函数。找到路径后把窗口内经过的格子写入预约表；提交时与别人冲突的 (格子, 时间片)
+ * 会在下一次搜索中避开。起点当前时间片已被别人占用时，从下一个时间片开始预约。
+ *
+ * 智能体需要在走完半个窗口左右时重新规划。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavCooperativePlanner
+{
+public:
+	/**
+	 * @param OutReservations 本次写入预约表的条目，重新规划或结束时用于释放
+	 * @return 窗口内每个时间片一个点（等待时重复），窗口之后是到终点的空间路径；不可达时为空
+	 */
+	static TArray<FVector> Plan(
+		const TMap<FVector, FAStarNode>& GridNodes,
+		float NodeSize,
+		FFlightNavReservationTable& ReservationTable,
+		const FFlightNavCooperativeRequest& Request,
+		TArray<FFlightNavSpaceTimeKey>& OutReservations,
+		FFlightNavQueryStats& OutStats);
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavDataHandle.generated.h"
+
+class UOctreeFlightComponent;
+class FFlightNavLandmarks;
+
+// 单个格子的查询结果
+USTRUCT(BlueprintType)
+struct FFlightNavCellInfo
+{
+	GENERATED_BODY()
+
+	// 格子中心
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation")
+	FVector Center = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation")
+	bool bIsWalkable = false;
+};
+
+/**
+ * 已烘焙导航数据的轻量句柄
+ *
+ * 只保存对所属导航组件的弱引用，拷贝句柄不会拷贝网格。
+ * 通过 UFlightNavigationBFL 中的查询函数或下面的 C++ 接口按需访问数据。
+ */
+USTRUCT(BlueprintType)
+struct FLGHTNAVIGATIONPLUGINS_API FFlightNavDataHandle
+{
+	GENERATED_BODY()
+
+	FFlightNavDataHandle() = default;
+	explicit FFlightNavDataHandle(const UOctreeFlightComponent* InOwner);
+
+	// 所属组件仍然存在且已经烘焙
+	bool IsValid() const;
+
+	// 直接访问网格（只读，不拷贝），句柄无效时返回 nullptr
+	const TMap<FVector, FAStarNode>* GetGrid() const;
+
+	// 烘焙时生成的 ALT 地标，未启用地标或句柄无效时返回 nullptr
+	const FFlightNavLandmarks* GetLandmarks() const;
+
+	float GetNodeSize() const;
+
+	// 网格的世界坐标范围
+	FBox GetBounds() const;
+
+	// 世界坐标所在的格子
+	const FAStarNode* FindCell(const FVector& WorldLocation) const;
+
+	/**
+	 * 遍历与 Region 相交的格子，只访问 Region 内的格子，不遍历整个网格；Region.Max 视为开区间
+	 *
+	 * @param Visitor 返回 false 时停止遍历
+	 */
+	void ForEachCellInBox(const FBox& Region, TFunctionRef<bool(const FAStarNode&)> Visitor) const;
+
+private:
+	UPROPERTY()
+	TWeakObjectPtr<UOctreeFlightComponent> Owner;
+};
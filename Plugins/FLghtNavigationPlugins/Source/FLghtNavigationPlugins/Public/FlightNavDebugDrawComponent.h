@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/PrimitiveComponent.h"
+#include "FlightNavDebugDrawComponent.generated.h"
+
+class UOctreeFlightComponent;
+
+/**
+ * 体素网格的批量调试绘制
+ *
+ * SceneProxy 创建时把整个网格一次性转换为线段列表的顶点/索引缓冲，按区块与 LOD 级别分段，
+ * 每帧只按视点距离为每个区块挑选一段索引提交，不再逐体素绘制。
+ * 由控制台变量 FlightNav.Debug.Draw 开关，关闭时不创建 SceneProxy，也不拷贝任何网格数据。
+ * 其余显示选项（切片、距离 LOD、只显示阻挡/路径）见 FlightNav.Debug.* 控制台变量，切片变化时重建 SceneProxy。
+ */
+UCLASS(ClassGroup=(Custom))
+class FLGHTNAVIGATIONPLUGINS_API UFlightNavDebugDrawComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UFlightNavDebugDrawComponent();
+
+	// 设置要绘制的导航组件
+	void SetSourceComponent(UOctreeFlightComponent* InSourceComponent);
+
+	// 数据来源的网格或路径变化后调用，调试绘制关闭时直接返回
+	void RefreshDebugDraw();
+
+	// FlightNav.Debug.Draw 是否打开（GameThread）
+	static bool IsDebugDrawEnabled();
+
+	//~ Begin UPrimitiveComponent Interface
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	virtual void GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials = false) const override;
+	//~ End UPrimitiveComponent Interface
+
+private:
+	UPROPERTY(Transient)
+	TWeakObjectPtr<UOctreeFlightComponent> SourceComponent;
+};
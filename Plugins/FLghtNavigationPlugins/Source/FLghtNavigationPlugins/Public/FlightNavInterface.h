@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "UObject/Interface.h"
 #include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavDataHandle.h"
 #include "FlightNavInterface.generated.h"
 
 struct FAStarNode;
@@ -24,7 +25,7 @@ class FLGHTNAVIGATIONPLUGINS_API IFlightNavInterface
 
 	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
 public:
-	//获取已生成的路径点
+	//获取已烘焙导航数据的句柄（不拷贝网格）
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "FlightNavInterface")
-	TMap<FVector, FAStarNode> GetVexolGrids();
+	FFlightNavDataHandle GetFlightNavData();
 };
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+
+/**
+ * ALT（A*, Landmarks, Triangle inequality）启发函数的数据
+ *
+ * 烘焙时选出若干地标格子，并行计算每个地标到所有可通行格子的最短距离。
+ * 查询时用三角不等式 |d(L, goal) - d(L, n)| 得到 n 到终点距离的下界，
+ * 在墙体、峡谷等复杂场景中比欧几里得距离紧得多。
+ *
+ * 距离表应在禁飞盒生效之前计算。禁飞盒关闭格子只会让距离变大；打开时只恢复格子在烘焙时的状态
+ * （见 UOctreeFlightComponent::UpdateVoxelsInObstructionBox），可通行格子始终是建表时的子集，下界仍然可采纳。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavLandmarks
+{
+public:
+	/**
+	 * 选择地标并计算距离表
+	 *
+	 * 地标按欧几里得最远点采样选出（首个地标为离网格中心最远的可通行格子），
+	 * 每个地标的距离表在工作线程上并行计算。
+	 */
+	void Build(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize, int32 NumLandmarks);
+
+	void Reset();
+
+	bool IsValid() const { return LandmarkCells.Num() > 0; }
+
+	int32 Num() const { return LandmarkCells.Num(); }
+
+	const TArray<FVector>& GetLandmarkCells() const { return LandmarkCells; }
+
+	// 取出终点到各地标的距离，同一次查询中复用；终点不在表中时返回 false
+	bool PrepareGoal(const FVector& GoalCell, TArray<float>& OutGoalDistances) const;
+
+	// Cell 到终点的 ALT 下界；Cell 不在表中或不可达时返回 0
+	float GetLowerBound(const FVector& Cell, TConstArrayView<float> GoalDistances) const;
+
+	// 取出一组终点到各地标距离的最小值与最大值；有终点不在表中时返回 false，与某个终点不连通的地标不再提供信息
+	bool PrepareGoalSet(TConstArrayView<FVector> GoalCells, TArray<float>& OutMinGoalDistances, TArray<float>& OutMaxGoalDistances) const;
+
+	// Cell 到一组终点中最近者的 ALT 下界 max(min_g d(L, g) - d(L, n), d(L, n) - max_g d(L, g), 0)，只有一个终点时与 GetLowerBound 相同
+	float GetLowerBoundToSet(const FVector& Cell, TConstArrayView<float> MinGoalDistances, TConstArrayView<float> MaxGoalDistances) const;
+
+	// 距离表占用的内存（字节）
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// 可通行格子中心 -> 距离表下标
+	TMap<FVector, int32> CellIndices;
+
+	TArray<FVector> LandmarkCells;
+
+	// Distances[地标][格子下标]，不可达为 TNumericLimits<float>::Max()
+	TArray<TArray<float>> Distances;
+};
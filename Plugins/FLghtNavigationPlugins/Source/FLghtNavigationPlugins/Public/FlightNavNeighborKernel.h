@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 一次展开中 26 个邻居的代价，按 4 路向量对齐补齐到 28 个
+struct FFlightNavNeighborBatch
+{
+	static constexpr int32 NumNeighbors = 26;
+	static constexpr int32 PaddedNeighbors = 28;
+
+	// 经过当前节点到达邻居的 g 值
+	alignas(16) float G[PaddedNeighbors];
+	// 邻居到终点的启发值（欧几里得距离）
+	alignas(16) float H[PaddedNeighbors];
+};
+
+/**
+ * 邻居展开的向量化计算
+ *
+ * 用整数格子偏移在单精度下一次算出 26 个邻居的 g 与 h，
+ * 通过 VectorRegister4Float 映射到 SSE / NEON，不依赖具体平台。
+ * 邻居顺序与 UFlightNavigationBFL::GetNeighborGridCenters 一致。
+ */
+namespace FlightNavNeighborKernel
+{
+	// 第 Index 个邻居的整数偏移
+	FLGHTNAVIGATIONPLUGINS_API const FIntVector& GetOffset(int32 Index);
+
+	// 向量化计算
+	FLGHTNAVIGATIONPLUGINS_API void Evaluate(const FIntVector& Cell, const FIntVector& GoalCell, float CurrentG, float NodeSize, FFlightNavNeighborBatch& OutBatch);
+
+	// 标量实现，用于对照与基准测试
+	FLGHTNAVIGATIONPLUGINS_API void EvaluateScalar(const FIntVector& Cell, const FIntVector& GoalCell, float CurrentG, float NodeSize, FFlightNavNeighborBatch& OutBatch);
+
+	// 格子中心 <-> 整数格子坐标，与 GetGridCenter 的换算一致
+	FORCEINLINE FIntVector ToCell(const FVector& GridCenter, float NodeSize)
+	{
+		return FIntVector(
+			FMath::FloorToInt(GridCenter.X / NodeSize),
+			FMath::FloorToInt(GridCenter.Y / NodeSize),
+			FMath::FloorToInt(GridCenter.Z / NodeSize));
+	}
+
+	FORCEINLINE FVector ToCenter(const FIntVector& Cell, float NodeSize)
+	{
+		return FVector(Cell.X, Cell.Y, Cell.Z) * NodeSize + FVector(NodeSize * 0.5f);
+	}
+
+	// 与 Box 相交的格子范围（闭区间）；Box.Max 视为开区间，恰好落在格子边界上时不包含外侧那一层
+	FORCEINLINE void ToCellRange(const FBox& Box, float NodeSize, FIntVector& OutMinCell, FIntVector& OutMaxCell)
+	{
+		OutMinCell = ToCell(Box.Min, NodeSize);
+		const FIntVector MaxCell = ToCell(Box.Max - FVector(KINDA_SMALL_NUMBER), NodeSize);
+		OutMaxCell = FIntVector(
+			FMath::Max(MaxCell.X, OutMinCell.X),
+			FMath::Max(MaxCell.Y, OutMinCell.Y),
+			FMath::Max(MaxCell.Z, OutMinCell.Z));
+	}
+}
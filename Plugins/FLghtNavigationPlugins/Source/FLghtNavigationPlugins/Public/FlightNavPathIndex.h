@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+#include "FlightNavPathIndex.generated.h"
+
+// 一条订阅路径因格子变为不可通行而失效
+USTRUCT(BlueprintType)
+struct FFlightNavPathInvalidation
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|PathIndex")
+	int32 SubscriptionId = INDEX_NONE;
+
+	// 第一个变为不可通行的路径点下标；该点前后的两段失效，在它之前的路径仍可继续飞行
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|PathIndex")
+	int32 FirstInvalidIndex = INDEX_NONE;
+
+	// 落在变为不可通行的格子中的路径点数
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|PathIndex")
+	int32 NumInvalidPoints = 0;
+};
+
+DECLARE_DELEGATE_OneParam(FOnFlightNavPathInvalidatedNative, const FFlightNavPathInvalidation&);
+
+/**
+ * 格子 -> 经过它的订阅路径 的索引
+ *
+ * 格子状态变化时只查找被修改的格子，直接得到受影响的路径和失效位置，
+ * 代价与修改的格子数和真正受影响的路径数成正比，与智能体总数无关。
+ * 同一 World 中的所有导航网格共用一个索引，GridId 区分不同网格（即所属组件的 UniqueID）。
+ *
+ * 订阅 / 退订可在任意线程进行；失效回调在调用 Invalidate 的线程上执行，
+ * 执行前订阅已被移除，回调中可以直接重新寻路并重新订阅。
+ * 回调已失去绑定（所属对象被销毁）的订阅在失效时或订阅数增长时的清理中移除。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavPathIndex
+{
+public:
+	// 订阅一条路径，返回订阅编号
+	int32 Subscribe(uint32 GridId, float NodeSize, TConstArrayView<FVector> Path, FOnFlightNavPathInvalidatedNative OnInvalidated);
+
+	void Unsubscribe(int32 SubscriptionId);
+
+	// 找出经过 Cells 的订阅，按订阅编号汇总失效位置
+	void CollectAffected(uint32 GridId, TConstArrayView<FIntVector> Cells, TMap<int32, FFlightNavPathInvalidation>& OutAffected) const;
+
+	// 移除受影响的订阅并通知
+	void Invalidate(const TMap<int32, FFlightNavPathInvalidation>& Affected);
+
+	// 网格被重新烘焙或销毁，该网格上的所有订阅失效
+	void InvalidateGrid(uint32 GridId);
+
+	int32 Num() const;
+
+private:
+	struct FCellKey
+	{
+		uint32 GridId = 0;
+		FIntVector Cell = FIntVector::ZeroValue;
+
+		bool operator==(const FCellKey& Other) const
+		{
+			return GridId == Other.GridId && Cell == Other.Cell;
+		}
+
+		friend uint32 GetTypeHash(const FCellKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.Cell), ::GetTypeHash(Key.GridId));
+		}
+	};
+
+	struct FEntry
+	{
+		int32 SubscriptionId;
+		// 第一次经过该格子的路径点
+		int32 PointIndex;
+		// 落在该格子中的路径点数
+		int32 NumPoints;
+	};
+
+	struct FSubscription
+	{
+		uint32 GridId = 0;
+		// 路径经过的格子（去重）
+		TArray<FIntVector> Cells;
+		int32 NumPoints = 0;
+		FOnFlightNavPathInvalidatedNative OnInvalidated;
+	};
+
+	// 调用方需持有写锁
+	bool RemoveLocked(int32 SubscriptionId, FOnFlightNavPathInvalidatedNative* OutDelegate);
+
+	// 移除回调已失去绑定的订阅；调用方需持有写锁
+	void PruneUnboundLocked();
+
+	mutable FRWLock Lock;
+	TMap<FCellKey, TArray<FEntry>> CellEntries;
+	TMap<int32, FSubscription> Subscriptions;
+	int32 NextSubscriptionId = 1;
+	// 订阅数达到该值时清理一次，清理后翻倍，摊还到每次订阅为常数
+	int32 PruneThreshold = 64;
+};
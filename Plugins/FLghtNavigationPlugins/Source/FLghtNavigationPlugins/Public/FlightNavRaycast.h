@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavRaycast.generated.h"
+
+// 一条待检测的线段
+USTRUCT(BlueprintType)
+struct FFlightNavRaySegment
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Raycast")
+	FVector Start = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Raycast")
+	FVector End = FVector::ZeroVector;
+};
+
+// 线段的首个阻挡结果
+USTRUCT(BlueprintType)
+struct FFlightNavRayHit
+{
+	GENERATED_BODY()
+
+	// 线段途经了不可通行的格子
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Raycast")
+	bool bBlockingHit = false;
+
+	// 进入阻挡格子的位置；未阻挡时为终点
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Raycast")
+	FVector Location = FVector::ZeroVector;
+
+	// 阻挡格子的中心
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Raycast")
+	FVector CellCenter = FVector::ZeroVector;
+
+	// 起点到 Location 的距离
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Raycast")
+	float Distance = 0.0f;
+};
+
+/**
+ * 基于烘焙网格的射线检测
+ *
+ * 用 3D DDA（Amanatides & Woo）按顺序访问线段经过的每个格子，
+ * 每个格子只做一次哈希查找，不经过物理场景。
+ * 批量接口把线段分块后在工作线程上并行处理；调用期间网格不能被修改（禁飞盒更新在游戏线程上进行，同步调用即可保证）。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavRaycast
+{
+public:
+	/**
+	 * 检测单条线段
+	 *
+	 * @param bTreatMissingAsBlocked 为 true 时网格外或缺失的格子视为阻挡
+	 * @return 存在阻挡时返回 true
+	 */
+	static bool Trace(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize,
+		const FVector& Start, const FVector& End, bool bTreatMissingAsBlocked, FFlightNavRayHit& OutHit);
+
+	// 批量检测首个阻挡，OutHits 与 Segments 一一对应
+	static void TraceBatch(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize,
+		TConstArrayView<FFlightNavRaySegment> Segments, bool bTreatMissingAsBlocked, TArray<FFlightNavRayHit>& OutHits);
+
+	// 批量检测视线，OutVisible[i] 为 true 表示第 i 条线段无阻挡
+	static void LineOfSightBatch(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize,
+		TConstArrayView<FFlightNavRaySegment> Segments, bool bTreatMissingAsBlocked, TArray<bool>& OutVisible);
+
+	// 每个并行任务处理的线段数；少于该数量时直接在调用线程上执行
+	static constexpr int32 SegmentsPerTask = 64;
+};
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavStats.h"
+#include <atomic>
+
+class UOctreeFlightComponent;
+
+/*-----------录制文件格式-----------------*/
+// 录制文件（.fnrec）：文件头后是按时间顺序排列的事件，网格快照单独保存为 .fnsnap，事件中只记录文件名与 CRC
+namespace FlightNavRecording
+{
+	static constexpr uint32 LogMagic = 0x4C524E46;      // "FNRL"
+	static constexpr uint32 SnapshotMagic = 0x4E534E46; // "FNSN"
+	static constexpr uint32 Version = 1;
+	// 快照位图用 int32 下标，超过这个格子数的包围范围无法保存
+	static constexpr int64 MaxSnapshotCells = MAX_int32;
+
+	enum class EEventType : uint8
+	{
+		// 重新烘焙，之后的事件作用在该快照上
+		GridSnapshot,
+		// 一组格子的可通行状态被修改（禁飞盒开关）
+		CellsChanged,
+		// 一次 FindFlightPath
+		PathQuery
+	};
+
+	// 每个事件共有的字段，StreamId 区分同一场景中的多个导航组件
+	struct FEventHeader
+	{
+		EEventType Type = EEventType::PathQuery;
+		double TimeSeconds = 0.0;
+		uint32 StreamId = 0;
+	};
+
+	struct FGridSnapshotEvent
+	{
+		// 相对录制文件所在目录
+		FString SnapshotFile;
+		uint32 Crc = 0;
+		float NodeSize = 0.0f;
+		int32 NumLandmarks = 0;
+	};
+
+	struct FCellsChangedEvent
+	{
+		bool bIsWalkable = true;
+		TArray<FIntVector> Cells;
+	};
+
+	struct FPathQueryEvent
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector Goal = FVector::ZeroVector;
+		int32 PathPoints = 0;
+		// 路径点的 CRC，重放时用来判断结果是否与录制时一致
+		uint32 PathHash = 0;
+		int32 NodesExpanded = 0;
+		float WallTimeMs = 0.0f;
+	};
+
+	FLGHTNAVIGATIONPLUGINS_API FArchive& operator<<(FArchive& Ar, FEventHeader& Header);
+	FLGHTNAVIGATIONPLUGINS_API FArchive& operator<<(FArchive& Ar, FGridSnapshotEvent& Event);
+	FLGHTNAVIGATIONPLUGINS_API FArchive& operator<<(FArchive& Ar, FCellsChangedEvent& Event);
+	FLGHTNAVIGATIONPLUGINS_API FArchive& operator<<(FArchive& Ar, FPathQueryEvent& Event);
+
+	FLGHTNAVIGATIONPLUGINS_API uint32 HashPath(TConstArrayView<FVector> Path);
+
+	/**
+	 * 网格快照
+	 *
+	 * 按包围格子范围存两份位图（格子是否存在、是否可通行），每个格子 2 bit。
+	 */
+	struct FLGHTNAVIGATIONPLUGINS_API FGridSnapshot
+	{
+		float NodeSize = 0.0f;
+		FIntVector MinCell = FIntVector::ZeroValue;
+		FIntVector Dimensions = FIntVector::ZeroValue;
+		TBitArray<> Present;
+		TBitArray<> Walkable;
+
+		// 包围范围超过 MaxSnapshotCells 时返回 false
+		static bool FromGrid(const TMap<FVector, FAStarNode>& GridNodes, float NodeSize, FGridSnapshot& OutSnapshot);
+		void ToGrid(TMap<FVector, FAStarNode>& OutGrid) const;
+
+		// 修改单个格子的可通行状态，不在快照中的格子忽略
+		void SetWalkable(const FIntVector& Cell, bool bWalkable);
+
+		// 序列化为字节并计算 CRC
+		void SaveToBytes(TArray<uint8>& OutBytes) const;
+		bool LoadFromBytes(const TArray<uint8>& Bytes);
+
+		friend FArchive& operator<<(FArchive& Ar, FGridSnapshot& Snapshot);
+	};
+}
+
+/**
+ * 导航查询与网格变化的录制
+ *
+ * 录制期间记录每次 FindFlightPath、禁飞盒开关影响的格子，以及每次烘焙后的网格快照，
+ * 之后可用 FFlightNavReplayer（控制台 FlightNav.Replay 或 -run=FlightNavReplay）离线重放并对比耗时。
+ * 未录制时各记录函数只检查一个原子标志。
+ *
+ * 控制台：FlightNav.Record.Start [文件路径]、FlightNav.Record.Stop
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavRecorder
+{
+public:
+	static FFlightNavRecorder& Get();
+
+	static bool IsRecording() { return bRecording.load(std::memory_order_relaxed); }
+
+	// 开始录制；FilePath 为空时写到 Saved/Profiling/FlightNav 下
+	bool Start(const FString& FilePath = FString());
+
+	void Stop();
+
+	// 烘焙完成（禁飞盒生效之前）时调用，保存网格快照
+	void RecordBake(const UOctreeFlightComponent& Component);
+
+	// 一组格子的可通行状态被修改后调用
+	void RecordCellsChanged(const UOctreeFlightComponent& Component, TConstArrayView<FAStarNode*> Nodes, bool bIsWalkable);
+
+	// 一次 FindFlightPath 完成后调用
+	void RecordPathQuery(const UOctreeFlightComponent& Component, const FVector& Start, const FVector& Goal,
+		TConstArrayView<FVector> Path, const FFlightNavQueryStats& Stats);
+
+private:
+	// 写入事件头；该组件还没有快照时先补一份快照
+	void BeginEvent(const UOctreeFlightComponent& Component, FlightNavRecording::EEventType Type);
+	void WriteSnapshot(const UOctreeFlightComponent& Component);
+
+	static std::atomic<bool> bRecording;
+
+	FCriticalSection RecorderCriticalSection;
+	TUniquePtr<FArchive> Writer;
+	FString LogFilePath;
+	double StartSeconds = 0.0;
+	int32 NumSnapshots = 0;
+	int32 NumEvents = 0;
+	TSet<uint32> StreamsWithSnapshot;
+};
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "FlightNavReplayCommandlet.generated.h"
+
+/**
+ * 无界面重放录制文件
+ *
+ * UnrealEditor-Cmd <项目> -run=FlightNavReplay -Log=<录制文件> [-Repeat=N] [-Csv=<输出路径>]
+ * 所有查询都重放成功返回 0；有查询的路径点数与录制时不同返回 2，便于在 CI 中对比版本。
+ */
+UCLASS()
+class FLGHTNAVIGATIONPLUGINS_API UFlightNavReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UFlightNavReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
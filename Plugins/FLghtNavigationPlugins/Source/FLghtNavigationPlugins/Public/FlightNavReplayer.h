@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FlightNavRecorder.h"
+
+// 重放中一次寻路查询的结果
+struct FFlightNavReplayQueryResult
+{
+	int32 QueryIndex = 0;
+	uint32 StreamId = 0;
+	double RecordedTimeSeconds = 0.0;
+	FVector Start = FVector::ZeroVector;
+	FVector Goal = FVector::ZeroVector;
+
+	int32 RecordedPathPoints = 0;
+	int32 ReplayPathPoints = 0;
+	uint32 RecordedPathHash = 0;
+	uint32 ReplayPathHash = 0;
+	int32 RecordedNodesExpanded = 0;
+	int32 ReplayNodesExpanded = 0;
+	float RecordedMs = 0.0f;
+	// 多次重复中的最短耗时
+	float ReplayMs = 0.0f;
+
+	// 该组件在录制中没有可用的网格快照时为 false，Replay* 字段无意义
+	bool bReplayed = false;
+
+	// 路径点不同，说明寻路结果与录制时不一致
+	bool IsMismatch() const { return bReplayed && (RecordedPathPoints != ReplayPathPoints || RecordedPathHash != ReplayPathHash); }
+};
+
+/**
+ * 离线重放录制文件
+ *
+ * 不需要场景或物理：按录制顺序恢复网格快照、应用格子变化，
+ * 再用 UFlightNavigationBFL::FindPathWithStats 重新执行每次查询并计时，
+ * 用于在真实流量上对比不同版本的寻路性能。重放期间的查询不计入 FFlightNavMetrics。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavReplayer
+{
+public:
+	// 读取录制文件的全部事件
+	bool Load(const FString& LogFilePath, FString& OutError);
+
+	/**
+	 * 按顺序重放所有事件
+	 *
+	 * @param Repeat 每次查询执行的次数，取最短耗时以减少噪声
+	 */
+	bool Run(int32 Repeat, TArray<FFlightNavReplayQueryResult>& OutResults, FString& OutError) const;
+
+	// 输出耗时分布、与录制时的对比以及最慢的查询
+	static void LogSummary(const TArray<FFlightNavReplayQueryResult>& Results);
+
+	// 每次查询一行写出 CSV
+	static bool WriteCsv(const TArray<FFlightNavReplayQueryResult>& Results, const FString& CsvPath);
+
+	int32 GetNumEvents() const { return Events.Num(); }
+
+private:
+	struct FEvent
+	{
+		FlightNavRecording::FEventHeader Header;
+		FlightNavRecording::FGridSnapshotEvent Snapshot;
+		FlightNavRecording::FCellsChangedEvent CellsChanged;
+		FlightNavRecording::FPathQueryEvent Query;
+	};
+
+	FString LogDirectory;
+	TArray<FEvent> Events;
+};
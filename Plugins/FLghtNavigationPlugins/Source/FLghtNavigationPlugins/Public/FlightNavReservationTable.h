@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+// 时空格子：某个体素在某个时间片
+struct FFlightNavSpaceTimeKey
+{
+	FIntVector Cell = FIntVector::ZeroValue;
+	int32 TimeSlot = 0;
+
+	FFlightNavSpaceTimeKey() = default;
+	FFlightNavSpaceTimeKey(const FIntVector& InCell, int32 InTimeSlot)
+		: Cell(InCell)
+		, TimeSlot(InTimeSlot)
+	{
+	}
+
+	bool operator==(const FFlightNavSpaceTimeKey& Other) const
+	{
+		return Cell == Other.Cell && TimeSlot == Other.TimeSlot;
+	}
+
+	friend uint32 GetTypeHash(const FFlightNavSpaceTimeKey& Key)
+	{
+		return HashCombine(GetTypeHash(Key.Cell), ::GetTypeHash(Key.TimeSlot));
+	}
+};
+
+/**
+ * 协同寻路的时空预约表
+ *
+ * 记录 (格子, 时间片) 被哪个智能体占用。按哈希分成多个分片，每个分片一把读写锁，
+ * 上千个智能体在不同线程上同时查询 / 预约时基本不会互相等待。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavReservationTable
+{
+public:
+	// 表示无人占用的智能体 ID
+	static constexpr uint32 NoAgent = 0;
+
+	// 返回占用者，无人占用时返回 NoAgent
+	uint32 GetOwner(const FIntVector& Cell, int32 TimeSlot) const;
+
+	// 预约成功或已被自己占用时返回 true
+	bool TryReserve(const FIntVector& Cell, int32 TimeSlot, uint32 AgentId);
+
+	// 释放 AgentId 自己的预约，别人的不受影响
+	void Release(TConstArrayView<FFlightNavSpaceTimeKey> Keys, uint32 AgentId);
+
+	// 删除早于 TimeSlot 的全部预约
+	void PruneBefore(int32 TimeSlot);
+
+	int32 Num() const;
+
+private:
+	static constexpr int32 NumShards = 64;
+
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FShard
+	{
+		mutable FRWLock Lock;
+		TMap<FFlightNavSpaceTimeKey, uint32> Entries;
+	};
+
+	FShard& GetShard(const FFlightNavSpaceTimeKey& Key) { return Shards[GetTypeHash(Key) % NumShards]; }
+	const FShard& GetShard(const FFlightNavSpaceTimeKey& Key) const { return Shards[GetTypeHash(Key) % NumShards]; }
+
+	FShard Shards[NumShards];
+};
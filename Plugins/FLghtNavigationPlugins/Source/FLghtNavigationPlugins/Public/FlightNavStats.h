@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "FlightNavStats.generated.h"
+
+FLGHTNAVIGATIONPLUGINS_API DECLARE_LOG_CATEGORY_EXTERN(LogFlightNav, Log, All);
+
+/*-----------Stat 分组（控制台 stat FlightNav 查看）-----------------*/
+DECLARE_STATS_GROUP(TEXT("FlightNav"), STATGROUP_FlightNav, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bake Voxel Grid"), STAT_FlightNav_Bake, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Landmarks"), STAT_FlightNav_BuildLandmarks, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Ban Box"), STAT_FlightNav_UpdateBanBox, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path"), STAT_FlightNav_FindPath, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Voxel Raycast"), STAT_FlightNav_Raycast, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Queries"), STAT_FlightNav_Queries, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_FlightNav_NodesExpanded, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Heap Operations"), STAT_FlightNav_HeapOperations, STATGROUP_FlightNav, FLGHTNAVIGATIONPLUGINS_API);
+
+// 需要统计耗时的导航操作
+UENUM(BlueprintType)
+enum class EFlightNavMetric : uint8
+{
+	FindPath,
+	Bake,
+	BanBoxUpdate,
+	Count UMETA(Hidden)
+};
+
+// 单次寻路的统计数据
+USTRUCT(BlueprintType)
+struct FFlightNavQueryStats
+{
+	GENERATED_BODY()
+
+	// 出队并展开的节点数
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	int32 NodesExpanded = 0;
+
+	// 开放集堆操作次数（Push / Pop / 重排）
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	int32 HeapOperations = 0;
+
+	// 墙钟耗时（毫秒）
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	float WallTimeMs = 0.0f;
+};
+
+// 滚动窗口内的耗时分布
+USTRUCT(BlueprintType)
+struct FFlightNavLatencySummary
+{
+	GENERATED_BODY()
+
+	// 窗口内的样本数
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	int32 SampleCount = 0;
+
+	// 自启动（或上次重置）以来的样本总数
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	int64 TotalCount = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	float MeanMs = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	float P50Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	float P95Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	float P99Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	float MaxMs = 0.0f;
+
+	// 直方图桶计数，上界见 BucketUpperBoundsMs，最后一个桶无上界
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	TArray<int32> HistogramBuckets;
+
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	TArray<float> BucketUpperBoundsMs;
+};
+
+/**
+ * 导航耗时的全局统计
+ *
+ * 每类操作保留最近 WindowSize 个样本，汇总时再计算分位数与直方图。
+ * 可在任意线程记录，读取通过控制台命令 FlightNav.Stats.Dump 或蓝图。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavMetrics
+{
+public:
+	static constexpr int32 WindowSize = 1024;
+
+	static FFlightNavMetrics& Get();
+
+	// 作用域内忽略本线程的所有记录，用于离线重放等不属于运行时流量的查询
+	class FLGHTNAVIGATIONPLUGINS_API FScopedSuppress
+	{
+	public:
+		FScopedSuppress();
+		~FScopedSuppress();
+	};
+
+	// 记录一次操作的耗时
+	void RecordLatency(EFlightNavMetric Metric, double Milliseconds);
+
+	// 累加一次寻路的计数
+	void RecordQuery(const FFlightNavQueryStats& Stats);
+
+	FFlightNavLatencySummary GetSummary(EFlightNavMetric Metric) const;
+
+	void Reset();
+
+	// 输出所有统计到日志
+	void DumpToLog() const;
+
+private:
+	struct FRollingWindow
+	{
+		TArray<float> Samples;
+		int32 NextIndex = 0;
+		int64 TotalCount = 0;
+	};
+
+	FRollingWindow Windows[static_cast<int32>(EFlightNavMetric::Count)];
+
+	int64 TotalNodesExpanded = 0;
+	int64 TotalHeapOperations = 0;
+
+	mutable FCriticalSection MetricsCriticalSection;
+};
+
+// 作用域计时：析构时把耗时写入 FFlightNavMetrics
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavScopedLatency
+{
+public:
+	explicit FFlightNavScopedLatency(EFlightNavMetric InMetric);
+	~FFlightNavScopedLatency();
+
+	// 到目前为止的耗时（毫秒）
+	double GetElapsedMs() const;
+
+private:
+	EFlightNavMetric Metric;
+	double StartSeconds;
+};
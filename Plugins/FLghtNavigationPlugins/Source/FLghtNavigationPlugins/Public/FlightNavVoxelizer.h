@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AFlightNavMeshBoundsVolume.h"
+#include "FlightNavVoxelizer.generated.h"
+
+class UWorld;
+class UBodySetup;
+class UStaticMesh;
+class UPrimitiveComponent;
+
+// 烘焙时判断格子占用的方式
+UENUM(BlueprintType)
+enum class EFlightNavVoxelizer : uint8
+{
+	// 每个格子一次物理盒体重叠查询（需要物理场景）
+	PhysicsOverlap,
+	// 直接读取碰撞几何并光栅化到网格（不需要物理场景，可在 commandlet 中运行）
+	GeometryRasterization
+};
+
+/**
+ * 碰撞几何光栅化
+ *
+ * 在游戏线程上收集阻挡 ECC_Visibility 的组件的碰撞几何：
+ * 简单碰撞（盒体、球体、胶囊体、凸包）按实心处理。球体与胶囊体做精确的距离测试，
+ * 盒体与凸包只做面平面的分离测试，棱角附近可能比物理重叠查询多标记少量格子；
+ * 使用复杂碰撞作为简单碰撞（CTF_UseComplexAsSimple）的静态网格读取三角形，只标记表面经过的格子。
+ * 之后按 X 切片在工作线程上并行光栅化，每个切片只写自己的格子，不需要加锁。
+ *
+ * 所有测试都是保守的（宁可多标记阻挡），每个格子的结果只取决于几何本身，
+ * 与收集顺序和线程调度无关，同一场景多次烘焙结果一致。
+ * 没有物理场景时也可运行，离线烘焙见 UFlightNavBakeCommandlet（-run=FlightNavBake）。
+ */
+class FLGHTNAVIGATIONPLUGINS_API FFlightNavVoxelizer
+{
+public:
+	FFlightNavVoxelizer(const FVector& InMinBounds, const FVector& InMaxBounds, float InVoxelSize);
+
+	// 收集 World 所有关卡中的碰撞几何
+	void GatherWorld(const UWorld* World);
+
+	// 收集单个组件的碰撞几何（实例化静态网格按实例展开）
+	void AddComponent(UPrimitiveComponent* Component);
+
+	// 光栅化并输出网格，格子顺序与 UFlightNavigationBFL::GenerateVoxelGrid 一致；格子数超过 MaxCells 时返回 false
+	bool Rasterize(TMap<FVector, FAStarNode>& OutGrid) const;
+
+	// 网格与占用表都用 int32 下标
+	static constexpr int64 MaxCells = MAX_int32;
+
+	int32 GetNumSolids() const { return Solids.Num(); }
+	int32 GetNumTriangles() const { return Triangles.Num(); }
+
+private:
+	enum class ESolidType : uint8
+	{
+		Convex,
+		Sphere,
+		Capsule
+	};
+
+	// 实心的简单碰撞体（世界空间）
+	struct FSolid
+	{
+		ESolidType Type = ESolidType::Convex;
+		FBox Bounds = FBox(ForceInit);
+		// Convex：外法线平面，点在所有平面内侧即在凸包内
+		TArray<FPlane> Planes;
+		// Sphere：A 为球心；Capsule：A、B 为轴线两端
+		FVector A = FVector::ZeroVector;
+		FVector B = FVector::ZeroVector;
+		double Radius = 0.0;
+	};
+
+	// 碰撞三角形（世界空间）
+	struct FTriangle
+	{
+		FVector V0;
+		FVector V1;
+		FVector V2;
+		FBox Bounds;
+	};
+
+	void AddBodySetup(const UBodySetup* BodySetup, UStaticMesh* StaticMesh, const FTransform& Transform, const FBox& FallbackBounds);
+	bool AddTriangleMesh(UStaticMesh* StaticMesh, const FTransform& Transform);
+	void AddConvex(TArray<FPlane>&& Planes, const FBox& Bounds);
+
+	// Box 覆盖的格子范围，不与网格相交时返回 false
+	bool GetCellRange(const FBox& Box, FIntVector& OutMin, FIntVector& OutMax) const;
+
+	static bool SolidOverlapsCell(const FSolid& Solid, const FVector& Center, const FVector& HalfExtent);
+	static bool TriangleOverlapsCell(const FTriangle& Triangle, const FVector& Center, const FVector& HalfExtent);
+
+	FVector MinBounds;
+	float VoxelSize;
+	FIntVector Dimensions;
+	FBox GridBox;
+
+	TArray<FSolid> Solids;
+	TArray<FTriangle> Triangles;
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlightNavReservationTable.h"
+#include "FlightNavPathIndex.h"
+#include <atomic>
+#include "FlightNavWorldSubsystem.generated.h"
+
+/**
+ * 同一个 World 中所有飞行导航组件共享的数据
+ *
+ * 保存协同寻路的时空预约表，以及格子到订阅路径的索引。
+ */
+UCLASS()
+class FLGHTNAVIGATIONPLUGINS_API UFlightNavWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// 每个时间片的时长（秒）；协同寻路假设智能体每个时间片移动一格或原地等待
+	UPROPERTY(BlueprintReadWrite, Category = "FlightNavigation|Cooperative")
+	float SecondsPerTimeSlot = 0.25f;
+
+	// 当前世界时间对应的时间片
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|Cooperative")
+	int32 GetCurrentTimeSlot() const;
+
+	// 当前预约条目数
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|Cooperative")
+	int32 GetNumReservations() const { return ReservationTable.Num(); }
+
+	FFlightNavReservationTable& GetReservationTable() { return ReservationTable; }
+
+	// 删除已经过去的时间片上的预约；距上次清理不足 PruneIntervalSlots 时直接返回
+	void PruneExpiredReservations();
+
+	// 当前订阅的路径数
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|PathIndex")
+	int32 GetNumPathSubscriptions() const { return PathIndex.Num(); }
+
+	FFlightNavPathIndex& GetPathIndex() { return PathIndex; }
+
+private:
+	static constexpr int32 PruneIntervalSlots = 16;
+
+	FFlightNavReservationTable ReservationTable;
+
+	FFlightNavPathIndex PathIndex;
+
+	std::atomic<int32> LastPrunedTimeSlot { 0 };
+};
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "OctreeFlightComponent.h"
+#include "FlightNavStats.h"
+#include "FlightNavLandmarks.h"
+#include "FlightNavDataHandle.h"
+#include "FlightNavRaycast.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "FlightNavigationBFL.generated.h"
 
@@ -25,6 +29,37 @@ public:
 		const TMap<FVector, FAStarNode>& GridNodes,   // 所有网格节点
 		float NodeSize = 100.0f                       // 每个格子的尺寸（假设是立方体）
 	);
+
+	// 同 FindPath，额外输出本次搜索的统计数据；提供 Landmarks 时启发函数取欧几里得距离与 ALT 下界的较大者
+	// 不拷贝 GridNodes，节点的 g 值与父节点保存在每次查询自己的旁路表中
+	static TArray<FVector> FindPathWithStats(
+		const FVector& Start,
+		const FVector& Goal,
+		const TMap<FVector, FAStarNode>& GridNodes,
+		float NodeSize,
+		FFlightNavQueryStats& OutStats,
+		const FFlightNavLandmarks* Landmarks = nullptr
+	);
+	/**
+	 * 一次搜索找到 Goals 中代价最小的可达目标
+	 *
+	 * 与 FindPathWithStats 共用同一个搜索循环。启发函数取到目标包围盒的距离（O(1)，不随目标数增长），
+	 * 提供 Landmarks 时再与地标对目标集合的下界取较大者，两者都是到最近目标距离的下界。
+	 * 第一个出队的目标就是最近的目标，不需要对每个目标各寻路一次。
+	 * 不可通行的目标被忽略；网格外的目标与 FindPath 一样视为可通行。
+	 *
+	 * @param OutGoalIndex 到达的目标在 Goals 中的下标（多个目标落在同一格子时取第一个），没找到时为 INDEX_NONE
+	 */
+	static TArray<FVector> FindPathToNearestGoal(
+		const FVector& Start,
+		TConstArrayView<FVector> Goals,
+		const TMap<FVector, FAStarNode>& GridNodes,
+		float NodeSize,
+		int32& OutGoalIndex,
+		FFlightNavQueryStats& OutStats,
+		const FFlightNavLandmarks* Landmarks = nullptr
+	);
+
 	// 获取当前坐标对应的网格索引（格子中心点）
 	static FVector GetGridCenter(const FVector& WorldPos, float NodeSize);
 
@@ -51,20 +86,101 @@ public:
 	);
 	// 检测某个位置是否可通行（用 LineTrace 向下或全方位）
 	static bool IsLocationWalkable(const UWorld* World, const FVector& Location, float VoxelSize);
+	// 生成 Voxel 网格：直接光栅化碰撞几何，不做物理查询，可在没有物理场景时使用（见 FFlightNavVoxelizer）
+	static TMap<FVector,FAStarNode> GenerateVoxelGridFromGeometry(
+		const UWorld* World,
+		const FVector& MinBounds,
+		const FVector& MaxBounds,
+		float VoxelSize
+	);
 	/*-----------Voxel导航-----------------*/
 
 
 	
 	/*-----------动态障碍物包围盒-----------------*/
-    // 更新所有动态障碍物包围盒中的体素网格状态
+    // 更新所有动态障碍物包围盒中的体素网格状态；OutBakeBlockedCells 收集包围盒内烘焙时就不可通行的格子
 	static void UpdateVoxelsInAllObstructionBox(
 	const UWorld* World,
 		TArray<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>>& BanFlightNavMeshBoundsVolumes,
 		TMap<TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>,TArray<FAStarNode*>>& VexolinBanVoxelGrids,
 		TMap<FVector, FAStarNode>& VoxelGrids,
-		float NodeSize);
+		float NodeSize,
+		TSet<FVector>* OutBakeBlockedCells = nullptr);
 	/*-----------动态障碍物包围盒-----------------*/
 
-	/*-----------Debug-----------------*/
-	static void DrawDebugVoxelBlocked(const UWorld* World,const FVector& VoxelCenter, float NodeSize);
+	/*-----------导航数据查询（不拷贝网格）-----------------*/
+	// 获取组件已烘焙导航数据的句柄
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|NavData")
+	static FFlightNavDataHandle GetFlightNavDataHandle(const UOctreeFlightComponent* Component);
+
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|NavData")
+	static bool IsFlightNavDataValid(const FFlightNavDataHandle& NavData);
+
+	// 网格中的格子总数
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|NavData")
+	static int32 GetFlightNavCellCount(const FFlightNavDataHandle& NavData);
+
+	// 查找世界坐标所在的格子，不在网格中时返回 false
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|NavData")
+	static bool FindFlightNavCell(const FFlightNavDataHandle& NavData, const FVector& WorldLocation, FFlightNavCellInfo& OutCell);
+
+	// Region 内的格子是否全部可通行；bTreatMissingAsBlocked 为 true 时网格外或缺失的格子视为不可通行
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|NavData")
+	static bool IsFlightNavRegionWalkable(const FFlightNavDataHandle& NavData, const FBox& Region, bool bTreatMissingAsBlocked = true);
+
+	// 统计 Region 内可通行与不可通行的格子数
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|NavData")
+	static void CountFlightNavCellsInBox(const FFlightNavDataHandle& NavData, const FBox& Region, int32& OutWalkable, int32& OutBlocked);
+
+	/**
+	 * 取出 Region 内的格子中心，最多 MaxResults 个
+	 *
+	 * @return 结果被 MaxResults 截断时返回 true
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|NavData")
+	static bool GetFlightNavCellsInBox(const FFlightNavDataHandle& NavData, const FBox& Region, int32 MaxResults, bool bWalkableOnly, TArray<FVector>& OutCenters);
+
+	// 在句柄指向的导航数据上寻路，不拷贝网格，组件启用了地标时使用 ALT 启发函数
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|NavData")
+	static TArray<FVector> FindPathOnNavData(const FFlightNavDataHandle& NavData, const FVector& Start, const FVector& Goal);
+
+	// 在句柄指向的导航数据上寻找到 Goals 中最近可达目标的路径，OutGoalIndex 为到达的目标下标，没找到时为 -1
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|NavData")
+	static TArray<FVector> FindPathToNearestGoalOnNavData(const FFlightNavDataHandle& NavData, const FVector& Start, const TArray<FVector>& Goals, int32& OutGoalIndex);
+	/*-----------导航数据查询（不拷贝网格）-----------------*/
+
+	/*-----------体素射线检测-----------------*/
+	// 单条线段的视线检测，不经过物理场景
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Raycast")
+	static bool HasFlightNavLineOfSight(const FFlightNavDataHandle& NavData, const FVector& Start, const FVector& End, bool bTreatMissingAsBlocked = false);
+
+	// 单条线段的首个阻挡
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Raycast")
+	static bool RaycastFlightNav(const FFlightNavDataHandle& NavData, const FVector& Start, const FVector& End, bool bTreatMissingAsBlocked, FFlightNavRayHit& OutHit);
+
+	/**
+	 * 批量视线检测，在工作线程上并行执行
+	 *
+	 * @param OutVisible 与 Segments 一一对应，true 表示无阻挡
+	 * @return NavData 无效时返回 false
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Raycast")
+	static bool BatchFlightNavLineOfSight(const FFlightNavDataHandle& NavData, const TArray<FFlightNavRaySegment>& Segments,
+		bool bTreatMissingAsBlocked, TArray<bool>& OutVisible);
+
+	// 批量首个阻挡检测，OutHits 与 Segments 一一对应
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Raycast")
+	static bool BatchFlightNavRaycast(const FFlightNavDataHandle& NavData, const TArray<FFlightNavRaySegment>& Segments,
+		bool bTreatMissingAsBlocked, TArray<FFlightNavRayHit>& OutHits);
+	/*-----------体素射线检测-----------------*/
+
+	/*-----------统计-----------------*/
+	// 获取某类导航操作最近一段时间的耗时分布
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Stats")
+	static FFlightNavLatencySummary GetFlightNavLatencySummary(EFlightNavMetric Metric);
+
+	// 清空所有导航耗时统计
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Stats")
+	static void ResetFlightNavMetrics();
+	/*-----------统计-----------------*/
 };
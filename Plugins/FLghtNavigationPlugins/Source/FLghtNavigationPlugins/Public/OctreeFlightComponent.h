@@ -6,9 +6,17 @@
 #include "AFlightNavMeshBoundsVolume.h"
 #include "BanFlightNavMeshBoundsVolume.h"
 #include "Components/ActorComponent.h"
+#include "FlightNavStats.h"
+#include "FlightNavAnytimeSearch.h"
+#include "FlightNavReservationTable.h"
+#include "FlightNavLandmarks.h"
+#include "FlightNavDataHandle.h"
+#include "FlightNavVoxelizer.h"
+#include "FlightNavPathIndex.h"
 #include "OctreeFlightComponent.generated.h"
 
 
+class UFlightNavDebugDrawComponent;
 
 // ✅ 定义一个委托类型：当 Voxel 状态变化时触发
 // 参数可以是：变化的 Voxel 位置、是否可通行、
@@ -17,6 +25,27 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
 	bool, bIsPath
 	);
 
+// Anytime 寻路得到更优路径时触发
+// SuboptimalityBound：路径代价不超过最优代价的倍数；bIsFinal 为 true 时搜索已结束（Path 为空表示不可达）
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(
+	FOnAnytimePathImproved,
+	const TArray<FVector>&, NewPath,
+	float, SuboptimalityBound,
+	bool, bIsFinal
+	);
+
+// 订阅的路径因格子变为不可通行而失效时触发（订阅已被移除，可直接重新寻路并订阅）
+DECLARE_DYNAMIC_DELEGATE_OneParam(
+	FOnFlightNavPathInvalidated,
+	const FFlightNavPathInvalidation&, Invalidation
+	);
+
+// 本组件当前路径失效时触发
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(
+	FOnFlightPathInvalidated,
+	const FFlightNavPathInvalidation&, Invalidation
+	);
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class FLGHTNAVIGATIONPLUGINS_API UOctreeFlightComponent : public UActorComponent
 {
@@ -31,12 +60,37 @@ public:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation")
 	float NodeSize = 100.0f;
+
+	//烘焙时判断格子占用的方式；GeometryRasterization 不依赖物理场景，速度更快
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation")
+	EFlightNavVoxelizer Voxelizer = EFlightNavVoxelizer::PhysicsOverlap;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation")
 	FVector Start = FVector::ZeroVector;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation")
 	FVector Goal = FVector::ZeroVector;
 	
+	//Anytime 寻路的初始启发放大系数（越大越快得到首条路径，质量越差）
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Anytime", meta = (ClampMin = "1.0"))
+	float AnytimeInitialEpsilon = 2.5f;
+	//每得到一条路径后放大系数的减小量
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Anytime", meta = (ClampMin = "0.01"))
+	float AnytimeEpsilonStep = 0.5f;
+	//Anytime 寻路每帧最多展开的节点数
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Anytime", meta = (ClampMin = "1"))
+	int32 AnytimeExpansionsPerFrame = 2000;
+
+	//烘焙时生成的 ALT 地标数量，0 表示不使用地标启发函数
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Landmarks", meta = (ClampMin = "0", ClampMax = "64"))
+	int32 NumLandmarks = 0;
+
+	//为 true 时 FindFlightPath 使用协同寻路，避开其他智能体已预约的路线
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Cooperative")
+	bool bUseCooperativePlanning = false;
+	//协同寻路考虑其他智能体的时间片数，走完约一半时应重新规划
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FlightNavigation|Cooperative", meta = (ClampMin = "1"))
+	int32 CooperativeWindow = 16;
+
 	UPROPERTY(BlueprintReadOnly,Category="FlightNavigation")
 	FVector NavMeshMinBounds = FVector::ZeroVector;
 	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation")
@@ -50,16 +104,74 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "FlightNavigation")
 		TArray<FVector> FindFlightPath();
+
+	/**
+	 * @brief 寻找到多个候选目标中最近可达目标的飞行路径
+	 *
+	 * 一次搜索完成（见 UFlightNavigationBFL::FindPathToNearestGoal），不需要对每个候选目标分别寻路。
+	 * 结果写入当前路径，与 FindFlightPath 一样参与路径失效通知；找到路径时 Goal 改为选中的目标。
+	 *
+	 * @param Goals 候选目标的世界坐标
+	 * @param OutGoalIndex 到达的目标在 Goals 中的下标，没找到时为 -1
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation")
+	TArray<FVector> FindFlightPathToNearest(const TArray<FVector>& Goals, int32& OutGoalIndex);
 	
+	/**
+	 * @brief 协同寻路（窗口化分层协同 A*）
+	 *
+	 * 从当前时间片开始规划，窗口内避开其他智能体已预约的 (格子, 时间片)，并预约自己的路线。
+	 * 之前的预约会先被释放。返回的路径在窗口内每个时间片一个点（原地等待时重复），
+	 * 时间片长度见 UFlightNavWorldSubsystem::SecondsPerTimeSlot。
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Cooperative")
+	TArray<FVector> FindCooperativeFlightPath();
+
+	//释放本组件在预约表中的全部预约
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Cooperative")
+	void ReleaseCooperativeReservations();
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * @brief 开始分帧执行的 Anytime 寻路（ARA*）
+	 *
+	 * 每帧最多展开 AnytimeExpansionsPerFrame 个节点。先以放大的启发函数尽快得到一条次优路径，
+	 * 之后逐帧改进直到最优，每得到更优路径就触发 OnAnytimePathImproved。
+	 * 搜索过程中网格发生变化会自动重新开始。
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Anytime")
+	void BeginAnytimeFlightPath();
+
+	//取消正在进行的 Anytime 寻路，已得到的路径保留
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|Anytime")
+	void CancelAnytimeFlightPath();
+
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation|Anytime")
+	bool IsAnytimeSearchActive() const { return bAnytimeSearchActive; }
+
+	//Anytime 寻路得到更优路径的委托
+	UPROPERTY(BlueprintAssignable, Category = "FlightNavigation|Anytime")
+	FOnAnytimePathImproved OnAnytimePathImproved;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
 	/**
 	 * @brief 初始化并生成飞行导航网格
 	 * 
 	 * 初始化飞行导航系统所需的体素网格数据，为后续路径规划做准备
 	 * 
-	 * @return FAStarNode数组，表示初始化后的体素网格节点数据
+	 * @return 导航数据句柄，通过 UFlightNavigationBFL 的 NavData 查询函数访问，不拷贝网格
 	 */
 	UFUNCTION(BlueprintCallable, Category = "FlightNavigation")
-	TMap<FVector, FAStarNode> InitializeGenerateFlightNavMesh();
+	FFlightNavDataHandle InitializeGenerateFlightNavMesh();
+
+	//按导航体积计算烘焙范围（对齐到 NodeSize），未设置导航体积时返回 false
+	bool ComputeNavMeshBounds(FVector& OutMinBounds, FVector& OutMaxBounds) const;
+
+	//已烘焙导航数据的句柄
+	UFUNCTION(BlueprintPure, Category = "FlightNavigation")
+	FFlightNavDataHandle GetNavDataHandle() const { return FFlightNavDataHandle(this); }
 	
 	/**
 	 * 更新阻挡盒内的体素状态
@@ -83,18 +195,49 @@ public:
     FVector GetBanBoxCenter(UPARAM(ref)TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>& BanBox);
 
 
-	//可视化被阻塞的区域
-	UFUNCTION(BlueprintCallable, Category = "FlightNavigation")
-	void DrawDebugVoxelBlocked(const FAStarNode& Voxel);
-
 	//Voxel状态发生改变的委托
 	 UPROPERTY(BlueprintAssignable, Category = "FlightNavigation")
 	 FOnVoxelStateChanged OnVoxelStateChanged;
 
-	//全体体素网格数据
-	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation")
+	//当前路径经过的格子变为不可通行时触发，带第一个失效的路径点下标
+	UPROPERTY(BlueprintAssignable, Category = "FlightNavigation|PathIndex")
+	FOnFlightPathInvalidated OnFlightPathInvalidated;
+
+	/**
+	 * @brief 订阅一条在本组件网格上的路径
+	 *
+	 * 网格中该路径经过的格子变为不可通行（禁飞盒开启、重新烘焙）时只通知这条路径，
+	 * 其他智能体不会收到任何回调。回调触发时订阅已被移除。
+	 * 回调所属对象销毁后订阅会被自动清理。
+	 *
+	 * @param AgentPath 通常为 FindPathOnNavData 的结果
+	 * @return 订阅编号，用于 UnsubscribePath；本组件不在 World 中或回调未绑定时返回 -1
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|PathIndex")
+	int32 SubscribePath(const TArray<FVector>& AgentPath, FOnFlightNavPathInvalidated OnInvalidated);
+
+	UFUNCTION(BlueprintCallable, Category = "FlightNavigation|PathIndex")
+	void UnsubscribePath(int32 SubscriptionId);
+
+	//全体体素网格数据（运行时生成，不序列化；蓝图请通过 GetNavDataHandle 查询）
 	TMap<FVector, FAStarNode> VoxelGrids;
 
+	//当前路径（FindFlightPath 的最近结果）
+	const TArray<FVector>& GetCurrentPath() const { return Path; }
+
+	//当前被禁飞盒关闭的格子（不含烘焙时就被几何体阻挡的），把它们恢复为可通行即得到烘焙时的网格
+	void GetBanClosedVoxels(TArray<const FAStarNode*>& OutVoxels) const;
+
+	//烘焙时生成的 ALT 地标，未启用时返回 nullptr
+	const FFlightNavLandmarks* GetLandmarks() const { return Landmarks.IsValid() ? &Landmarks : nullptr; }
+
+	//网格或路径变化后刷新调试绘制；FlightNav.Debug.Draw 关闭时什么也不做
+	void RefreshDebugDraw();
+
+	//最近一次 FindFlightPath 的统计数据
+	UPROPERTY(BlueprintReadOnly, Category = "FlightNavigation|Stats")
+	FFlightNavQueryStats LastQueryStats;
+
 
 	
 private:
@@ -107,9 +250,38 @@ private:
 	//障碍物包围盒
 	TMap<FVector, TSoftObjectPtr<ABanFlightNavMeshBoundsVolume>> BanVoxelGrids;
 
+	//禁飞盒内烘焙时就被几何体阻挡的格子，禁飞盒打开时保持不可通行
+	TSet<FVector> BakeBlockedBanCells;
+
 	// ⭐ 加锁对象：保护 VoxelGrid 的读写
 	FCriticalSection VoxelGridCriticalSection;
 
 	//广播函数
 	void BroadcastVoxelStateChanged(bool bIsPath);
+
+	//ALT 地标距离表，随网格一起烘焙
+	FFlightNavLandmarks Landmarks;
+
+	//协同寻路时写入预约表的条目
+	TArray<FFlightNavSpaceTimeKey> CooperativeReservations;
+
+	//Anytime 寻路状态
+	TUniquePtr<FFlightNavAnytimeSearch> AnytimeSearch;
+	bool bAnytimeSearchActive = false;
+
+	//网格变化后，正在进行的 Anytime 寻路需要重新开始
+	void RestartAnytimeSearchIfActive();
+
+	//当前路径在路径索引中的订阅
+	int32 PathSubscriptionId = INDEX_NONE;
+
+	//Path 变化后重新订阅
+	void UpdatePathSubscription();
+
+	//World 共享的路径索引，没有 World 时为 nullptr
+	FFlightNavPathIndex* GetPathIndex() const;
+
+	//网格调试绘制（FlightNav.Debug.Draw 打开时才会创建渲染数据）
+	UPROPERTY(Transient)
+	TObjectPtr<UFlightNavDebugDrawComponent> DebugDrawComponent;
 };